@@ -0,0 +1,148 @@
+//
+// chart.c - Sweeping strip chart, drawn to the LCD a column at a time
+//
+
+#include <stdint.h>
+
+#include "chart.h"
+#include "st7565.h"
+
+// The column at c->head is the one being filled, and is shown blank (the
+// sweep front); the columns before it, going back round the ring, hold
+// the newest samples to the oldest.
+
+
+void chartInit(chart_t *c, chartCol_t *ring,
+               uint8_t x, uint8_t width, uint8_t page, uint8_t pages,
+               int16_t lo, int16_t hi, uint8_t decimate)
+{
+    c->ring = ring;
+    c->x = x;
+    c->width = width;
+    c->page = page;
+    c->pages = pages;
+    c->lo = lo;
+    c->hi = hi;
+    c->decimate = decimate ? decimate : 1;
+    c->head = 0;
+    c->count = 0;
+    c->full = 0;
+
+    chartRedraw(c);
+}
+
+// Pixel row (0 at the top) a value is drawn at
+static int16_t rowOf(chart_t *c, int16_t v)
+{
+    int16_t h = c->pages * 8 - 1;
+
+    if(v >= c->hi) return 0;
+    if(v <= c->lo) return h;
+    return (int32_t)(c->hi - v) * h / (c->hi - c->lo);
+}
+
+static uint8_t hasSamples(chart_t *c, uint8_t col)
+{
+    return col != c->head && (c->full || col < c->head);
+}
+
+// Rows top..bot that column col covers: its min to max, stretched to meet
+// the previous column's. Returns 0 if the column is blank.
+static uint8_t colRows(chart_t *c, uint8_t col, int16_t *top, int16_t *bot)
+{
+    uint8_t prev = col ? col - 1 : c->width - 1;
+    int16_t t;
+
+    if(!hasSamples(c, col)) return 0;
+
+    *top = rowOf(c, c->ring[col].max);
+    *bot = rowOf(c, c->ring[col].min);
+
+    if(hasSamples(c, prev)) {
+        t = rowOf(c, c->ring[prev].min);    // Previous was higher
+        if(t < *top - 1) *top = t + 1;
+        t = rowOf(c, c->ring[prev].max);    // Previous was lower
+        if(t > *bot + 1) *bot = t - 1;
+    }
+    return 1;
+}
+
+// The byte of page p (of the chart) showing rows top..bot
+static uint8_t pageBits(int16_t top, int16_t bot, uint8_t p)
+{
+    top -= p * 8;
+    bot -= p * 8;
+    if(bot < 0 || top > 7) return 0;
+    if(top < 0) top = 0;
+    if(bot > 7) bot = 7;
+    return (0xFF >> top) & (0xFF << (7 - bot));
+}
+
+// Draw column col, the blank one after it (the sweep front, at c->head),
+// and the one after that: the oldest, which no longer has a column before
+// it to join up with.
+//
+static void drawFront(chart_t *c, uint8_t col)
+{
+    uint8_t n = c->width < 3 ? c->width : 3;
+    uint8_t run = c->width - col < n ? c->width - col : n;  // Before the wrap
+    uint8_t i, p, lit[3], d[3];
+    int16_t top[3], bot[3];
+
+    for(i = 0; i < n; i++)
+        lit[i] = colRows(c, (col + i) % c->width, &top[i], &bot[i]);
+
+    for(p = 0; p < c->pages; p++)
+    {
+        for(i = 0; i < n; i++)
+            d[i] = lit[i] ? pageBits(top[i], bot[i], p) : 0;
+        lcdWriteSpan(c->page + p, c->x + col, d, run);
+        if(run < n)
+            lcdWriteSpan(c->page + p, c->x, &d[run], n - run);
+    }
+}
+
+void chartAdd(chart_t *c, int16_t value)
+{
+    chartCol_t *cp = &c->ring[c->head];
+    uint8_t col;
+
+    if(c->count == 0) {
+        cp->min = cp->max = value;
+    } else {
+        if(value < cp->min) cp->min = value;
+        if(value > cp->max) cp->max = value;
+    }
+    if(++c->count < c->decimate)
+        return;
+
+    // Column complete: on to the next, and show this one
+    c->count = 0;
+    col = c->head;
+    if(++c->head >= c->width) {
+        c->head = 0;
+        c->full = 1;
+    }
+    drawFront(c, col);
+}
+
+void chartSetRange(chart_t *c, int16_t lo, int16_t hi)
+{
+    c->lo = lo;
+    c->hi = hi;
+    chartRedraw(c);
+}
+
+void chartRedraw(chart_t *c)
+{
+    static uint8_t row[LCD_MAX_WIDTH];
+    uint8_t p, col;
+    int16_t top, bot;
+
+    for(p = 0; p < c->pages; p++)
+    {
+        for(col = 0; col < c->width; col++)
+            row[col] = colRows(c, col, &top, &bot) ? pageBits(top, bot, p) : 0;
+        lcdWriteSpan(c->page + p, c->x, row, c->width);
+    }
+}
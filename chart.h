@@ -0,0 +1,65 @@
+#ifndef __CHART_H__
+#define __CHART_H__
+
+#include <stdint.h>
+
+//
+// Strip chart
+//
+// A live trace of sampled values, drawn directly to the LCD (like the
+// console, no bitmap buffer) in a rectangle of whole pages. The chart
+// sweeps: each new column is drawn over the oldest one, at a position that
+// moves one column to the right each time and wraps around, with a blank
+// column just ahead of it marking the sweep front. So a sample costs a few
+// columns of LCD writes (3 bytes per page: the new column, the blank one,
+// and the oldest), rather than a redraw of the whole trace.
+//
+// Columns are kept in a ring buffer (supplied by the caller, one entry
+// per column), so the chart can be redrawn, e.g. at a new scale.
+//
+// With more samples than columns, several samples go into each column
+// (decimation), and the column shows their minimum to maximum, so short
+// spikes are never lost. Consecutive columns are joined up, so steep
+// changes show as a continuous trace.
+//
+// The trace sweeps in place: columns stay where they were drawn, and the
+// sweep front moves across them. It doesn't scroll (by the display start
+// line, as the console does, or by an offset into the ring), since that
+// would move everything else on the screen too, or mean redrawing every
+// column per sample. So the chart owns its rectangle of the LCD, and the
+// display start line must be 0.
+//
+
+// One column's samples: the least and the greatest
+typedef struct {
+    int16_t min, max;
+} chartCol_t;
+
+typedef struct {
+    chartCol_t *ring;       // A column each, col is ring[col]
+    uint8_t  x, width;      // LCD columns x..x+width-1 (width >= 2)...
+    uint8_t  page, pages;   //   and pages page..page+pages-1
+    int16_t  lo, hi;        // Values at the bottom and top
+    uint8_t  decimate;      // Samples per column
+    uint8_t  head;          // Column the next sample goes in
+    uint8_t  count;         // Samples in it so far
+    uint8_t  full;          // All columns have had samples
+} chart_t;
+
+// Set up a chart, and clear its rectangle on the LCD. ring[] must have
+// "width" entries. Values lo..hi span the chart's height; others are
+// drawn at the edge.
+void chartInit(chart_t *c, chartCol_t *ring,
+               uint8_t x, uint8_t width, uint8_t page, uint8_t pages,
+               int16_t lo, int16_t hi, uint8_t decimate);
+
+// Add a sample. Every "decimate" samples, the column is drawn.
+void chartAdd(chart_t *c, int16_t value);
+
+// Change the vertical scale, and redraw
+void chartSetRange(chart_t *c, int16_t lo, int16_t hi);
+
+// Draw the whole chart from the ring buffer
+void chartRedraw(chart_t *c);
+
+#endif
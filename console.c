@@ -0,0 +1,156 @@
+//
+// console.c - Scrolling text console using the ST7565 start-line register
+//
+
+#include <stdint.h>
+#include <string.h>
+
+#include "console.h"
+#include "gfxFont.h"
+#include "st7565.h"
+
+#define LINES (CONSOLE_ROWS + CONSOLE_SCROLLBACK)  // Lines held in RAM
+
+// Line numbers count up from 0 for as long as the console runs. A line
+// always appears in the same LCD page: line % CONSOLE_ROWS. Scrolling is
+// done by moving the start line so that page lands where it should.
+
+//
+// Private variables
+//
+static char text[LINES][CONSOLE_COLS];          // Line n is text[n % LINES]
+static char shown[CONSOLE_ROWS][CONSOLE_COLS];  // What each LCD page shows
+static uint32_t lastLine;    // Line number of the newest (bottom) line
+static int16_t  curCol;      // Cursor column in the newest line
+static uint8_t  wrapPending; // Newline due before the next character
+static int16_t  backBy;      // Lines scrolled back by (0: live view)
+static int16_t  startPage = -1;  // Page count of the start line set
+
+// 5x7 pixel character font, as gfx draws text in (see gfxFont.h)
+#ifndef GFX_FONT
+#define GFX_FONT gfxFont5x8
+#endif
+extern const gfxFont_t GFX_FONT;
+
+
+void consoleInit(void)
+{
+    memset(shown, 0, sizeof(shown));  // (Never a console char; forces a redraw)
+    startPage = -1;
+    consoleClear();
+    consoleFlush();
+}
+
+void consoleClear(void)
+{
+    memset(text, ' ', sizeof(text));
+    lastLine = CONSOLE_ROWS - 1;      // Screen starts as lines 0..ROWS-1
+    curCol = 0;
+    wrapPending = 0;
+    backBy = 0;
+}
+
+// Start a new, blank line at the bottom
+static void newLine(void)
+{
+    lastLine++;
+    memset(text[lastLine % LINES], ' ', CONSOLE_COLS);
+    curCol = 0;
+}
+
+void consolePutc(char c)
+{
+    backBy = 0;
+
+    if(c == '\n') {
+        // Deferred, so the new line is drawn in one go with its text
+        if(wrapPending) newLine();
+        wrapPending = 1;
+        return;
+    }
+    if(c == '\r') {
+        curCol = 0;
+        return;
+    }
+
+    if(wrapPending || curCol >= CONSOLE_COLS) {
+        newLine();
+        wrapPending = 0;
+    }
+    text[lastLine % LINES][curCol++] = c;
+}
+
+void consolePuts(const char *s)
+{
+    while(*s)
+        consolePutc(*s++);
+    consoleFlush();
+}
+
+int16_t consoleScrollBack(int16_t lines)
+{
+    // Lines older than line 0 never existed; those past the
+    // scroll-back have been overwritten.
+    uint32_t avail = lastLine - (CONSOLE_ROWS - 1);
+
+    if(avail > CONSOLE_SCROLLBACK) avail = CONSOLE_SCROLLBACK;
+    if(lines > (int16_t)avail) lines = avail;
+    if(lines < 0) lines = 0;
+    backBy = lines;
+    return lines;
+}
+
+// Write cells first..last-1 of line n to its LCD page
+static void drawCells(uint32_t n, int16_t first, int16_t last)
+{
+    static uint8_t row[128];  // Page data for the cells being drawn
+    const char *t = text[n % LINES];
+    uint8_t page = n % CONSOLE_ROWS;
+    int16_t i, x, w;
+
+    x = first * 6;
+    for(i = first; i < last; i++) {
+        memcpy(&row[i * 6], gfxFontByte(&GFX_FONT, t[i]), 5);
+        row[i * 6 + 5] = 0;   // Space between characters
+        shown[page][i] = t[i];
+    }
+
+    w = (last - first) * 6;
+    if(first == 0 && last == CONSOLE_COLS) {
+        // Whole line: include the unused columns to the right, too
+        memset(&row[w], 0, sizeof(row) - w);
+        w = sizeof(row);
+    }
+    lcdWriteSpan(page, x, &row[x], w);
+}
+
+void consoleFlush(void)
+{
+    uint32_t top = lastLine - (CONSOLE_ROWS - 1) - backBy;
+    uint32_t n;
+    int16_t page = (CONSOLE_ROWS - top % CONSOLE_ROWS) % CONSOLE_ROWS;
+    int16_t i, first;
+    const char *t, *s;
+
+    // Put the top line's page at the top of the display
+    if(page != startPage) {
+        startPage = page;
+        lcdSetStartLine(page * 8);
+    }
+
+    for(n = top; n < top + CONSOLE_ROWS; n++)
+    {
+        t = text[n % LINES];
+        s = shown[n % CONSOLE_ROWS];
+
+        // Runs of changed cells (the whole line, on scrolling in)
+        for(i = 0; i < CONSOLE_COLS; )
+        {
+            if(t[i] == s[i]) { i++; continue; }
+            first = i;
+            while(i < CONSOLE_COLS && t[i] != s[i])
+                i++;
+            drawCells(n, first, i);
+        }
+    }
+}
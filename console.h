@@ -0,0 +1,51 @@
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include <stdint.h>
+
+//
+// Scrolling text console
+//
+// A 21x8 character terminal drawn directly to the LCD (no bitmap buffer),
+// in GFX_FONT, as gfx's text is (characters are CP437 bytes, as gfxChar's
+// are). New lines are scrolled in with the ST7565's display start-line
+// register, so appending a line costs one page of LCD writes rather than
+// a full redraw.
+//
+// Output is buffered as characters. consoleFlush() compares them against
+// what the LCD is showing, cell by cell, and writes only the cells that
+// changed.
+//
+// The console owns the display while in use: it moves the start line, so
+// set it back to 0 (lcdSetStartLine) before using lcdWriteBuffer again.
+//
+
+#define CONSOLE_COLS  21   // 128 pixels / 6 pixel character cells
+#define CONSOLE_ROWS   8   // One row per LCD page
+
+// Lines kept in RAM beyond those on screen, for consoleScrollBack().
+// CONSOLE_COLS bytes of RAM each.
+#ifndef CONSOLE_SCROLLBACK
+#define CONSOLE_SCROLLBACK 0
+#endif
+
+// Clear the console and the LCD; the LCD must already be initialized
+void consoleInit(void);
+
+// Clear the console (including the scroll-back)
+void consoleClear(void);
+
+// Add text at the cursor. '\n' starts a new line, '\r' returns to the
+// start of the line; long lines wrap. consolePuts() also flushes.
+void consolePutc(char c);
+void consolePuts(const char *s);
+
+// Send changed cells to the LCD
+void consoleFlush(void);
+
+// View older lines: show the screen as it was "lines" lines ago (0 is the
+// live view). Limited to the scroll-back available; returns the number of
+// lines actually scrolled back. New output returns to the live view.
+int16_t consoleScrollBack(int16_t lines);
+
+#endif
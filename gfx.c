@@ -7,37 +7,518 @@
 #include <string.h>
 
 #include "gfx.h"
+#include "gfxFont.h"
+#include "st7565.h"
 
-// Byte swap macro
-#define swap(a, b) { uint8_t t = a; a = b; b = t; }
+#ifdef GFX_STATS
+#include <stdio.h>
+#ifndef DBPUTS
+#include "product_config.h"
+#endif
+#endif
+
+// Coordinate swap macro
+#define swap(a, b) { int16_t t = a; a = b; b = t; }
 
 // 
 // Private variables
 //
 static int16_t bmapWidth  = 0;  // Bitmap width (pixels)
 static int16_t bmapHeight = 0;  // Bitmap height (pixels)
-static uint8_t *bmap;            // The bitmap buffer
+static uint8_t *bmap;            // The bitmap buffer (NULL: draw to LCD RAM)
 static int16_t bmapSize;        // Size of the bitmap buffer (bytes)
+static int16_t bandPage  = 0;   // First page held in the buffer
+static int16_t bandPages = 0;   // Number of pages held in the buffer
+
+// Clip rectangle and drawing origin (see gfxPushClip). Coordinates given
+// to the primitives are relative to the origin; the clip rectangle is in
+// bitmap coordinates.
+typedef struct {
+    int16_t x0, y0, x1, y1;   // Clip rectangle (inclusive)
+    int16_t ox, oy;           // Origin
+} clip_t;
+
+static clip_t clip = { INT16_MIN, INT16_MIN, INT16_MAX, INT16_MAX, 0, 0 };
+static clip_t clipStack[GFX_CLIP_DEPTH];
+static int8_t clipDepth = 0;
+
+// Fill pattern, while a gfxPat* fill is drawing: the tile, moved to the
+// pattern origin, so column x of any page uses patRow[x & 7]
+static uint8_t patOn = 0;
+static uint8_t patRow[8];
+static int16_t patX = 0, patY = 0;  // Pattern origin (bitmap coordinates)
+
+// Drawable area right now, in bitmap coordinates: the clip rectangle, the
+// bitmap, and the pages in the band (or the RMW page being collected).
+// Primitives clip to this up front, so their inner loops don't check.
+// Kept up to date by setLimits().
+static int16_t limX0, limY0, limX1, limY1;
+
+// Read-modify-write mode (no bitmap buffer).
+//
+// Each primitive is run once per page it may touch. On each pass, only the
+// pixels falling in that page are collected (as column bit-masks), and they
+// are then applied to the LCD's display RAM in one read-modify-write burst
+// per run of adjacent columns. So a page is addressed once per primitive,
+// rather than once per pixel. Pixels go to display RAM as addressed, with
+// no rotation, so drawing is limited to the panel's own columns and pages.
+// On a write-only (serial) bus, where RMW can't be done, the masks are
+// written as they are: what's drawn shows, but it replaces the rest of the
+// bytes it touches.
+#define RMW_COLS 132                 // ST7565 has 132 segment columns
+static int16_t rmwWidth, rmwHeight; // The panel's display RAM, in pixels
+static int16_t rmwPage = -1;        // Page being collected; -1 when idle
+static int16_t rmwColMin, rmwColMax; // Extent of columns with mask bits set
+static uint8_t rmwMask[RMW_COLS];   // Pixels to modify, per column
+
+// Run "call" once per page between ya and yb (ya <= yb), when in RMW mode
+// and not already in a pass. Returns from the calling primitive afterwards.
+// (ya and yb are relative to the origin, as given to the primitive.)
+#define RMW_BY_PAGE(ya, yb, color, call)                      \
+    if(!bmap && rmwPage < 0) {                                 \
+        int16_t pg_, pgEnd_ = rmwPageOf((yb) + clip.oy);       \
+        for(pg_ = rmwPageOf((ya) + clip.oy); pg_ <= pgEnd_; pg_++) { \
+            rmwBegin(pg_);                                     \
+            call;                                              \
+            rmwEnd(color);                                     \
+        }                                                      \
+        return;                                                \
+    }
+
+// 5x7 pixel character font, with its Unicode index (see gfxFont.h)
+#ifndef GFX_FONT
+#define GFX_FONT gfxFont5x8
+#endif
+extern const gfxFont_t GFX_FONT;
+
+static const gfxFont_t *curFont = &GFX_FONT;
+
+// Where gfxPlotPoints and gfxPolyline report the columns they changed
+static void (*spanHook)(int16_t page, int16_t col0, int16_t col1);
+
+// Instrumentation (see gfxStatsDump)
+//
+// STAT(id), after a primitive's declarations, counts the call and times
+// it: the cleanup attribute ends the timing whichever way the function
+// returns. A primitive re-entered by itself (RMW passes) counts once.
+// Times include nested primitives (gfxRect's lines); bytes and pixels go
+// to the innermost.
+#ifdef GFX_STATS
+
+typedef struct {
+    int8_t   id, prev;      // id -1: nested in itself, not counted
+    uint32_t start;
+} statCtx_t;
+
+static gfxStat_t stats[GFX_ST_COUNT];
+static int8_t statCur = -1;     // Primitive running now
+
+static const char *const statName[GFX_ST_COUNT] = {
+    "Fill", "Pixel", "Line", "Rect", "FRect", "Circle", "FCircle",
+    "FillPoly", "Char", "String", "BigText", "Bitmap", "PlotPoints",
+    "Polyline", "Scroll"
+};
+
+static statCtx_t statBegin(int8_t id)
+{
+    statCtx_t ctx;
+
+    ctx.id = (id == statCur) ? -1 : id;
+    ctx.prev = statCur;
+    statCur = id;
+    ctx.start = tickNow();
+    return ctx;
+}
+
+static void statEnd(statCtx_t *ctx)
+{
+    uint32_t t = tickNow() - ctx->start;
+    gfxStat_t *st;
+    uint8_t b = 0;
+
+    if(ctx->id < 0) return;
+    statCur = ctx->prev;
+
+    st = &stats[ctx->id];
+    st->calls++;
+    st->ticks += t;
+    while(t > 1 && b < GFX_ST_BUCKETS - 1) {   // Bucket: floor(log2(t))
+        t >>= 1;
+        b++;
+    }
+    st->hist[b]++;
+}
+
+static void statTouch(uint16_t bytes, uint8_t mask)
+{
+    if(statCur < 0) return;
+    stats[statCur].bytes += bytes;
+    while(mask) {                   // Pixels: bits in the mask
+        stats[statCur].pixels++;
+        mask &= mask - 1;
+    }
+}
+
+#define STAT(id)  statCtx_t stat_ __attribute__((cleanup(statEnd))) = \
+                      statBegin(id)
+#define STAT_TOUCH(bytes, mask)  statTouch(bytes, mask)
+#define STAT_BYTES(n)   do { if(statCur >= 0) {                   \
+                             stats[statCur].bytes += (n);       \
+                             stats[statCur].pixels += (n) * 8; } } while(0)
+
+#else
+
+#define STAT(id)
+#define STAT_TOUCH(bytes, mask)
+#define STAT_BYTES(n)
+
+#endif
+
+static void setLimits(void);
+
+// Page holding row y, limited to the drawable pages
+static int16_t rmwPageOf(int16_t y)
+{
+    if(y < limY0) return limY0 / 8;
+    if(y > limY1) return limY1 / 8;
+    return y / 8;
+}
+
+// Start collecting the pixels of one page
+static void rmwBegin(int16_t page)
+{
+    rmwPage = page;
+    rmwColMin = RMW_COLS;
+    rmwColMax = -1;
+    setLimits();
+}
+
+// Apply the collected pixels of the current page to the LCD. Runs of
+// columns separated by a single untouched column are merged, since
+// re-addressing costs more bus cycles than modifying one spare byte.
+static void rmwEnd(uint8_t color)
+{
+    int16_t col, runStart;
+
+    col = rmwColMin;
+    while(col <= rmwColMax)
+    {
+        runStart = col;
+        while(col <= rmwColMax &&
+              (rmwMask[col] || (col < rmwColMax && rmwMask[col + 1])))
+            col++;
+        if(lcdModifySpan(rmwPage, runStart, &rmwMask[runStart],
+                         col - runStart, color)) {
+            // Can't read the LCD: write the bits (cleared ones as zeros)
+            if(!color)
+                memset(&rmwMask[runStart], 0, col - runStart);
+            lcdWriteSpan(rmwPage, runStart, &rmwMask[runStart],
+                         col - runStart);
+        }
+        while(col <= rmwColMax && !rmwMask[col])
+            col++;
+    }
+    memset(&rmwMask[0], 0, sizeof(rmwMask));
+    rmwPage = -1;
+    setLimits();
+}
+
+// Work out the drawable area (limX0.. etc.), after any change to the
+// clip rectangle, bitmap, band, or RMW page.
+static void setLimits(void)
+{
+    int16_t top = 0, bottom = bmapHeight - 1;
+
+    if(bmap) {
+        top = bandPage * 8;
+        bottom = (bandPage + bandPages) * 8 - 1;
+    }
+    else if(rmwPage >= 0) {
+        top = rmwPage * 8;
+        bottom = top + 7;
+    }
+    if(bottom > bmapHeight - 1) bottom = bmapHeight - 1;
+    if(!bmap && bottom > rmwHeight - 1) bottom = rmwHeight - 1;
+
+    limX0 = clip.x0 > 0 ? clip.x0 : 0;
+    limX1 = clip.x1 < bmapWidth - 1 ? clip.x1 : bmapWidth - 1;
+    if(!bmap && limX1 > rmwWidth - 1) limX1 = rmwWidth - 1;
+    limY0 = clip.y0 > top ? clip.y0 : top;
+    limY1 = clip.y1 < bottom ? clip.y1 : bottom;
+}
+
+// Set or clear the "mask" bits of the byte at a page and column (bitmap
+// coordinates). No range checks; callers have clipped to the limits.
+static void putMask(int16_t page, int16_t x, uint8_t mask, uint8_t color)
+{
+    uint8_t *p;
+
+    STAT_TOUCH(1, mask);
+    if(!bmap) {                     // RMW mode: collect this page's pixels
+        rmwMask[x] |= mask;
+        if(x < rmwColMin) rmwColMin = x;
+        if(x > rmwColMax) rmwColMax = x;
+        return;
+    }
+
+    p = &bmap[(page - bandPage) * bmapWidth + x];
+    if(color)
+        *p |= mask;                 // color != 0: Set the pixels
+    else
+        *p &= ~mask;                // color == 0: Clear the pixels
+}
+
+// Plot a pixel (bitmap coordinates), without / with the range check
+static void plot(int16_t x, int16_t y, uint8_t color)
+{
+    putMask(y / 8, x, 0x80 >> (y & 7), color);
+}
+
+static void plotClipped(int16_t x, int16_t y, uint8_t color)
+{
+    if(x < limX0 || x > limX1 || y < limY0 || y > limY1) return;
+    putMask(y / 8, x, 0x80 >> (y & 7), color);
+}
+
+// Rows of a page that are within the limits, as a mask
+static uint8_t rowMask(int16_t page)
+{
+    int16_t top = page * 8;
+    uint8_t mask = 0xff;
+
+    if(limY0 > top)     mask &= 0xff >> (limY0 - top);
+    if(limY1 < top + 7) mask &= 0xff << (7 - (limY1 - top));
+    return mask;
+}
+
+// Vertical span of pixels, ya..yb (ya <= yb), in column x (bitmap coords).
+// Clipped, then drawn a byte (up to 8 pixels) at a time.
+static void vSpan(int16_t x, int16_t ya, int16_t yb, uint8_t color)
+{
+    int16_t page;
+    uint8_t mask, pm = patOn ? patRow[x & 7] : 0xff;
+
+    if(x < limX0 || x > limX1) return;
+    if(ya < limY0) ya = limY0;
+    if(yb > limY1) yb = limY1;
+    if(ya > yb) return;
+
+    for(page = ya / 8; page <= yb / 8; page++)
+    {
+        mask = 0xff;
+        if(page == ya / 8) mask &= 0xff >> (ya & 7);
+        if(page == yb / 8) mask &= 0xff << (7 - (yb & 7));
+        putMask(page, x, mask & pm, color);
+    }
+}
+
+// Replace pixels with those of a page-format image: n columns, "pages"
+// pages (w bytes apart), at x,y (bitmap coords; y needn't be a multiple of
+// 8). "which" is 1 to clear the image's cells, 2 to set its bits, 3 both.
+static void blitCols(int16_t x, int16_t y, const uint8_t *img,
+                     int16_t n, int16_t pages, int16_t w, uint8_t which)
+{
+    uint8_t s = y & 7;                    // (Two's complement: works for y < 0)
+    int16_t page0 = (y - s) / 8;
+    int16_t c, c0, c1, pg, dp, lastPg = s ? pages : pages - 1;
+    const uint8_t *upper, *lower;         // Image pages landing in page dp
+    uint8_t bits, mask, *p;
+
+    // Columns within the limits
+    c0 = x < limX0 ? limX0 - x : 0;
+    c1 = x + n - 1 > limX1 ? limX1 - x : n - 1;
+
+    for(pg = 0; pg <= lastPg; pg++)
+    {
+        dp = page0 + pg;
+        if(dp < limY0 / 8 || dp > limY1 / 8) continue;
+
+        // Image page pg lands in the bottom of dp (shifted down s rows),
+        // and the one above it in the top
+        upper = pg > 0 && s ? &img[(pg - 1) * w] : NULL;
+        lower = pg < pages ? &img[pg * w] : NULL;
+        mask = (lower ? 0xff >> s : 0) | (upper ? 0xff << (8 - s) : 0);
+        mask &= rowMask(dp);
+
+        p = bmap ? &bmap[(dp - bandPage) * bmapWidth + x] : NULL;
+        for(c = c0; c <= c1; c++)
+        {
+            bits = 0;
+            if(lower) bits = lower[c] >> s;
+            if(upper) bits |= upper[c] << (8 - s);
+
+            if(p && which == 3) {
+                p[c] = (p[c] & ~mask) | (bits & mask);
+                STAT_TOUCH(1, mask);
+            }
+            else {
+                if(which & 1) putMask(dp, x + c, mask, 0);
+                if(which & 2) putMask(dp, x + c, bits & mask, 1);
+            }
+        }
+    }
+}
+
+// Replace pixels with a page-format image, as for blitCols. Whole bytes are
+// copied when the image is page-aligned and not clipped.
+static void blit(int16_t x, int16_t y, const uint8_t *img,
+                 int16_t n, int16_t pages, int16_t w)
+{
+    int16_t pg, page;
+
+    if(!(y & 7) && x >= limX0 && x + n - 1 <= limX1 &&
+       y >= limY0 && y + pages * 8 - 1 <= limY1)
+    {
+        STAT_BYTES((uint32_t)n * pages);
+        for(pg = 0; pg < pages; pg++, img += w)
+        {
+            if(!bmap)   // No buffer: Just write the bytes
+                lcdWriteSpan(y / 8 + pg, x, img, n);
+            else
+                memcpy(&bmap[(y / 8 + pg - bandPage) * bmapWidth + x], img, n);
+        }
+        return;
+    }
+
+    if(bmap) {
+        blitCols(x, y, img, n, pages, w, 3);
+        return;
+    }
 
-// 5x7 pixel character font definitions
-extern uint8_t font[];
+    // RMW mode: for each page, a pass to clear the cells, then one to set
+    // the image's bits.
+    for(page = rmwPageOf(y); page <= rmwPageOf(y + pages * 8 - 1); page++)
+    {
+        rmwBegin(page);
+        blitCols(x, y, img, n, pages, w, 1);
+        rmwEnd(0);
+        rmwBegin(page);
+        blitCols(x, y, img, n, pages, w, 2);
+        rmwEnd(1);
+    }
+}
 
 // "Constructor" - Init size variables, pointer to active bitmap buffer, and
 //                 clear the buffer.
+//                 With a NULL buffer, drawing goes straight to the LCD's
+//                 display RAM via read-modify-write (parallel mode; see
+//                 RMW mode above for serial).
 void gfxInit(int16_t width, int16_t height, uint8_t *_bmap)
 {
-	bmapWidth = width;
-	bmapHeight = height;
-    bmap = _bmap;
-    bmapSize = width * height / 8;  // Byte size of bitmap buffer
+    clipDepth = 0;
+    clip.x0 = clip.y0 = INT16_MIN;
+    clip.x1 = clip.y1 = INT16_MAX;
+    clip.ox = clip.oy = 0;
+    patX = patY = 0;
+
+    gfxInitBand(width, height, _bmap, 0, height / 8);
 
     gfxFill(0);  // Clear buffer
 }
 
 
-// Fill bitmap buffer (clear with gfxFill(0));
+// As gfxInit, but the buffer holds only some of the bitmap's pages (a band),
+// and it is not cleared. Pixels outside the band are discarded.
+void gfxInitBand(int16_t width, int16_t height, uint8_t *band,
+                 int16_t firstPage, int16_t nPages)
+{
+    lcdPanel_t *panel;
+
+    if(!band) {                 // RMW: the selected panel's display RAM
+        panel = lcdSelect(NULL);
+        lcdSelect(panel);
+        rmwWidth = panel->width;
+        rmwHeight = panel->pages * 8;
+    }
+
+    bmapWidth = width;
+    bmapHeight = height;
+    bmap = band;
+    bandPage = firstPage;
+    bandPages = nPages;
+    bmapSize = nPages * width;  // Byte size of the band
+    setLimits();
+}
+
+void gfxGetBand(int16_t *width, int16_t *height, uint8_t **band,
+                int16_t *firstPage, int16_t *nPages)
+{
+    *width = bmapWidth;
+    *height = bmapHeight;
+    *band = bmap;
+    *firstPage = bandPage;
+    *nPages = bandPages;
+}
+
+
+// Clip stack
+//
+// gfxPushClip narrows the clip rectangle to x0,y0..x1,y1 (relative to
+// the current origin). gfxPushViewport does the same, and also moves the
+// origin to x0,y0, so code can draw in local coordinates. gfxPopClip goes
+// back to the clip rectangle and origin before the last push.
+//
+static void pushClip(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                     uint8_t moveOrigin)
+{
+    if(clipDepth >= GFX_CLIP_DEPTH) return;
+    clipStack[clipDepth++] = clip;
+
+    if(x0 > x1) swap(x0, x1);
+    if(y0 > y1) swap(y0, y1);
+    x0 += clip.ox; x1 += clip.ox;
+    y0 += clip.oy; y1 += clip.oy;
+
+    if(x0 > clip.x0) clip.x0 = x0;
+    if(y0 > clip.y0) clip.y0 = y0;
+    if(x1 < clip.x1) clip.x1 = x1;
+    if(y1 < clip.y1) clip.y1 = y1;
+
+    if(moveOrigin) {
+        clip.ox = x0;
+        clip.oy = y0;
+    }
+    setLimits();
+}
+
+void gfxPushClip(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    pushClip(x0, y0, x1, y1, 0);
+}
+
+void gfxPushViewport(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    pushClip(x0, y0, x1, y1, 1);
+}
+
+void gfxPopClip(void)
+{
+    if(clipDepth == 0) return;
+    clip = clipStack[--clipDepth];
+    setLimits();
+}
+
+
+// Fill bitmap buffer (clear with gfxFill(0)). Not clipped.
 void gfxFill(uint8_t fillValue) {
-    memset(bmap, fillValue, bmapSize);
+    uint8_t fillRow[RMW_COLS];
+    int16_t page, w;
+    STAT(GFX_ST_FILL);
+
+    if(bmap) {
+        STAT_BYTES(bmapSize);
+        memset(bmap, fillValue, bmapSize);
+        return;
+    }
+
+    // No buffer: Plain writes will do, there's nothing to read back.
+    // Only the panel's own pages and columns (see RMW mode above).
+    memset(fillRow, fillValue, sizeof(fillRow));
+    w = bmapWidth < rmwWidth ? bmapWidth : rmwWidth;
+    for(page = 0; page < bmapHeight/8 && page < rmwHeight/8; page++) {
+        STAT_BYTES(w);
+        lcdWriteSpan(page, 0, fillRow, w);
+    }
 }
 
 // gfxPixel()
@@ -46,24 +527,16 @@ void gfxFill(uint8_t fillValue) {
 // appropriate bit in a bitmap buffer to turn-on (or off) that pixel.
 //
 // This version of gfxPixel has byte orientation arranged in "ST7565"
-// LCD controller format. TODO: arrange for other formats? Provide
-// conversion from *.bmp to this format?
+// LCD controller format (tools/pbm2img converts *.pbm and *.bmp images to
+// it). TODO: arrange for other formats?
 //
 void gfxPixel(int16_t x, int16_t y, uint8_t color)
 {
-    int16_t byteIdx;
-    uint8_t bitMask;
-
-    if(x < 0 || x >= bmapWidth) return;   // Range check
-    if(y < 0 || y >= bmapHeight) return;
+    STAT(GFX_ST_PIXEL);
 
-    byteIdx = y / 8 * bmapWidth + x;
-    bitMask = 0x80 >> (y & 7);
+    RMW_BY_PAGE(y, y, color, gfxPixel(x, y, color));
 
-    if(color)
-        bmap[byteIdx] |= bitMask;   // color != 0: Set the pixel
-    else
-        bmap[byteIdx] &= ~bitMask;  // color == 0: Clear the pixel
+    plotClipped(x + clip.ox, y + clip.oy, color);
 }
 
 
@@ -74,49 +547,209 @@ void gfxChar(int16_t x,      // Starting x location (in pixels)
              int16_t line,   // Starting line (0..7)
              char c)          // Character
 {
-    int16_t i, bmapIdx, fontIdx;
+    STAT(GFX_ST_CHAR);
 
-    bmapIdx = (int16_t)line * bmapWidth + x;
-    fontIdx = (int16_t)c * 5;
+    blit(x + clip.ox, line * 8 + clip.oy, gfxFontByte(curFont, c), 5, 1, 5);
+}
 
-    for (i =0; i<5; i++ ) // 5 bytes per character
-    {
-        bmap[bmapIdx++] = font[fontIdx++];
-    }
+// As gfxChar, for any code point
+void gfxCharU(int16_t x, int16_t line, uint16_t cp)
+{
+    STAT(GFX_ST_CHAR);
+
+    blit(x + clip.ox, line * 8 + clip.oy, gfxFontGlyph(curFont, cp), 5, 1, 5);
+}
+
+// Select the font for text (NULL: back to GFX_FONT)
+void gfxSetFont(const gfxFont_t *font)
+{
+    curFont = font ? font : &GFX_FONT;
+}
+
+// Number of characters in a UTF-8 string
+int16_t gfxTextLen(const char *c)
+{
+    int16_t n = 0;
+
+    while(gfxUtf8Next(&c)) n++;
+    return n;
+}
+
+
+//
+//  Copy a page-format image (w columns by "pages" 8-pixel lines) to the
+//  bitmap, at x (in pixels) and line (in 8-pixel lines).
+//
+void gfxBitmap(int16_t x, int16_t line,
+               int16_t w, int16_t pages, const uint8_t *img)
+{
+    int16_t skip, n;
+    STAT(GFX_ST_BITMAP);
+
+    // Trim columns outside the limits, so the fast path can take the rest
+    x += clip.ox;
+    skip = x < limX0 ? limX0 - x : 0;
+    n = w - skip;
+    if(x + w - 1 > limX1) n -= x + w - 1 - limX1;
+    if(n <= 0) return;
+
+    blit(x + skip, line * 8 + clip.oy, img + skip, n, pages, w);
 }
 
 
 void gfxString(int16_t x, int16_t line, char *c)
 {
-    while(*c)  // Until string null-terminator...
+    // Wrap at the right of the bitmap, and stop at its bottom (in viewport
+    // coordinates). Characters beyond the clip rectangle are clipped.
+    int16_t right  = bmapWidth - clip.ox;
+    int16_t bottom = (bmapHeight - clip.oy) / 8;
+    const char *p = c;
+    uint16_t cp;
+    STAT(GFX_ST_STRING);
+
+    while((cp = gfxUtf8Next(&p)) != 0)  // Until string null-terminator...
     {
-        gfxChar(x, line, *c++); // Plot one character
+        gfxCharU(x, line, cp);        // Plot one character
         x += 6;                       // x-position for next char
-        if (x + 6 >= bmapWidth)       // Will it fit on this line?
+        if (x + 6 >= right)           // Will it fit on this line?
         {
             x = 0;                    // If not, go to next line
             line++;
         }
-        if (line >= (bmapHeight/8))   // All out of lines?
+        if (line >= bottom)           // All out of lines?
             return;                   // If so, quit.
     }
 }
 
+
+//
+// Scaled text
+//
+// Each font column byte is stretched to "scale" bytes by looking up each
+// nibble in a table (4 bits -> 4*scale bits), and repeated "scale" times
+// across. The glyph is built as a small page-format image and goes out
+// through blit(), which handles alignment and clipping.
+//
+static const uint16_t expand2[16] = {
+    0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+    0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF
+};
+static const uint16_t expand3[16] = {
+    0x000, 0x007, 0x038, 0x03F, 0x1C0, 0x1C7, 0x1F8, 0x1FF,
+    0xE00, 0xE07, 0xE38, 0xE3F, 0xFC0, 0xFC7, 0xFF8, 0xFFF
+};
+static const uint16_t expand4[16] = {
+    0x0000, 0x000F, 0x00F0, 0x00FF, 0x0F00, 0x0F0F, 0x0FF0, 0x0FFF,
+    0xF000, 0xF00F, 0xF0F0, 0xF0FF, 0xFF00, 0xFF0F, 0xFFF0, 0xFFFF
+};
+
+static void bigGlyph(int16_t x, int16_t y, const uint8_t *glyph,
+                     uint8_t scale)
+{
+    uint8_t img[5 * 4 * 4];         // Up to 20 columns by 4 pages
+    const uint16_t *tab;
+    int16_t w = 5 * scale;
+    uint32_t v;
+    uint8_t i, j, pg, b;
+    STAT(GFX_ST_BIGTEXT);
+
+    switch(scale)
+    {
+    case 1:  blit(x + clip.ox, y + clip.oy, glyph, 5, 1, 5);
+             return;
+    case 2:  tab = expand2; break;
+    case 3:  tab = expand3; break;
+    case 4:  tab = expand4; break;
+    default: return;
+    }
+
+    for(i = 0; i < 5; i++)
+    {
+        v = ((uint32_t)tab[glyph[i] >> 4] << (4 * scale)) | tab[glyph[i] & 15];
+
+        // Top page is the most significant byte
+        for(pg = 0; pg < scale; pg++)
+        {
+            b = v >> (8 * (scale - 1 - pg));
+            for(j = 0; j < scale; j++)
+                img[pg * w + i * scale + j] = b;
+        }
+    }
+
+    blit(x + clip.ox, y + clip.oy, img, w, scale, w);
+}
+
+void gfxBigChar(int16_t x, int16_t y, char c, uint8_t scale)
+{
+    bigGlyph(x, y, gfxFontByte(curFont, c), scale);
+}
+
+void gfxBigString(int16_t x, int16_t y, char *c, uint8_t scale)
+{
+    const char *p = c;
+    uint16_t cp;
+
+    while((cp = gfxUtf8Next(&p)) != 0)
+    {
+        bigGlyph(x, y, gfxFontGlyph(curFont, cp), scale);
+        x += 6 * scale;
+    }
+}
+
+// Cohen-Sutherland outcode of a point against the limits
+#define OC_LEFT   1
+#define OC_RIGHT  2
+#define OC_TOP    4
+#define OC_BOTTOM 8
+
+static uint8_t outcode(int16_t x, int16_t y)
+{
+    uint8_t code = 0;
+
+    if(x < limX0) code |= OC_LEFT;
+    else if(x > limX1) code |= OC_RIGHT;
+    if(y < limY0) code |= OC_TOP;
+    else if(y > limY1) code |= OC_BOTTOM;
+    return code;
+}
+
 // Draw a line (using Bresenham's line algorithm)
 // TODO: Should the line include the endpoint?
 //
+// Clipping: Cohen-Sutherland outcodes trivially accept or reject the line.
+// Otherwise, the range of steps that lands inside the limits is worked out
+// from Bresenham's error term, and the line is started part way along.
+// So clipping never moves a pixel of the line, and the loop has no checks.
+//
 void gfxLine(int16_t x0, int16_t y0,
              int16_t x1, int16_t y1,
              uint8_t color) 
 {
     int16_t dx, dy;
     char     steep;
+    uint8_t  code0, code1;
+    int16_t  lo, hi, minLo, minHi;   // Limits, on the major / minor axis
+    int32_t  kFirst, kLast, k, m;
+    STAT(GFX_ST_LINE);
+
+    RMW_BY_PAGE(y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, color,
+                gfxLine(x0, y0, x1, y1, color));
+
+    x0 += clip.ox; x1 += clip.ox;
+    y0 += clip.oy; y1 += clip.oy;
+
+    code0 = outcode(x0, y0);
+    code1 = outcode(x1, y1);
+    if(code0 & code1) return;        // Wholly outside on one side
 
     steep = abs(y1 - y0) > abs(x1 - x0);
 
     if (steep) {
         swap(x0, y0);
         swap(x1, y1);
+        lo = limY0; hi = limY1; minLo = limX0; minHi = limX1;
+    } else {
+        lo = limX0; hi = limX1; minLo = limY0; minHi = limY1;
     }
     
     if (x0 > x1) {
@@ -134,13 +767,45 @@ void gfxLine(int16_t x0, int16_t y0,
         ystep = 1;
     } else {
         ystep = -1;}
-    
-    while(x0 < x1)
+
+    // Steps k = 0..dx-1 plot x0+k. After k steps, the minor axis has moved
+    // m(k) = max(0, ceil((k*dy - err)/dx)) times.
+    kFirst = 0;
+    kLast = dx - 1;
+    if(code0 | code1)
+    {
+        if(lo - x0 > kFirst) kFirst = lo - x0;
+        if(hi - x0 < kLast)  kLast = hi - x0;
+
+        // Steps needed to enter (m) / last allowed (k) on the minor axis
+        m = ystep > 0 ? minLo - y0 : y0 - minHi;
+        k = ystep > 0 ? minHi - y0 : y0 - minLo;
+        if(k < 0) return;
+        if(dy == 0) {
+            if(m > 0) return;
+        }
+        else {
+            if(m > 0 && ((m - 1) * dx + err) / dy + 1 > kFirst)
+                kFirst = ((m - 1) * dx + err) / dy + 1;
+            if((k * dx + err) / dy < kLast)
+                kLast = (k * dx + err) / dy;
+        }
+        if(kFirst > kLast) return;
+
+        // Start part way along
+        m = kFirst * dy - err;
+        m = m <= 0 ? 0 : (m + dx - 1) / dx;
+        y0 += ystep * m;
+        err += m * dx - kFirst * dy;
+        x0 += kFirst;
+    }
+
+    for(k = kFirst; k <= kLast; k++)
     {
         if (steep) {
-            gfxPixel(y0, x0, color);
+            plot(y0, x0, color);
         } else {
-            gfxPixel(x0, y0, color);
+            plot(x0, y0, color);
         }
         err -= dy;
         if (err < 0) {
@@ -158,6 +823,11 @@ void gfxRect(int16_t x0, int16_t y0,
              int16_t x1, int16_t y1,
              uint8_t color)
 {
+    STAT(GFX_ST_RECT);
+
+    RMW_BY_PAGE(y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, color,
+                gfxRect(x0, y0, x1, y1, color));
+
     gfxLine(x0,y0, x1,y0, color);
     gfxLine(x0,y1, x1,y1, color);
     gfxLine(x0,y0, x0,y1, color);
@@ -169,16 +839,40 @@ void gfxRect(int16_t x0, int16_t y0,
 //
 // Filled rectangle
 //
+// Clipped to the limits first, then filled a page at a time with byte
+// masks.
+//
 void gfxFRect(int16_t x0, int16_t y0,
 			  int16_t x1, int16_t y1,
               uint8_t color)
 {
-    int16_t i,j;
+    int16_t i, page;
+    uint8_t mask;
+    STAT(GFX_ST_FRECT);
 
-    for (i=x0; i<=x1; i++) {
-        for (j=y0; j<=y1; j++) {
-            gfxPixel(i, j, color);
-        }
+    RMW_BY_PAGE(y0, y1, color, gfxFRect(x0, y0, x1, y1, color));
+
+    x0 += clip.ox; x1 += clip.ox;
+    y0 += clip.oy; y1 += clip.oy;
+
+    if(x0 < limX0) x0 = limX0;
+    if(x1 > limX1) x1 = limX1;
+    if(y0 < limY0) y0 = limY0;
+    if(y1 > limY1) y1 = limY1;
+    if(x0 > x1 || y0 > y1) return;   // (Also: nothing, if given backwards)
+
+    for(page = y0 / 8; page <= y1 / 8; page++)
+    {
+        mask = 0xff;
+        if(page == y0 / 8) mask &= 0xff >> (y0 & 7);
+        if(page == y1 / 8) mask &= 0xff << (7 - (y1 & 7));
+
+        if(patOn)
+            for(i = x0; i <= x1; i++)
+                putMask(page, i, mask & patRow[i & 7], color);
+        else
+            for(i = x0; i <= x1; i++)
+                putMask(page, i, mask, color);
     }
 }
 
@@ -187,16 +881,31 @@ void gfxCircle(int16_t x0, int16_t y0,  // Center coord
                int16_t r,                // Radius
                uint8_t color)
 {
-    int8_t f = 1 - r;
-    int8_t ddF_x = 1;
-    int8_t ddF_y = -2 * r;
-    int8_t x = 0;
-    int8_t y = r;
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+    void (*pixel)(int16_t, int16_t, uint8_t);
+    STAT(GFX_ST_CIRCLE);
+
+    RMW_BY_PAGE(y0 - r, y0 + r, color, gfxCircle(x0, y0, r, color));
+
+    x0 += clip.ox;
+    y0 += clip.oy;
+
+    // Wholly outside: nothing to do. Wholly inside: no checks needed.
+    if(x0 + r < limX0 || x0 - r > limX1 || y0 + r < limY0 || y0 - r > limY1)
+        return;
+    if(x0 - r >= limX0 && x0 + r <= limX1 && y0 - r >= limY0 && y0 + r <= limY1)
+        pixel = plot;
+    else
+        pixel = plotClipped;
 
-    gfxPixel(x0, y0+r, color);
-    gfxPixel(x0, y0-r, color);
-    gfxPixel(x0+r, y0, color);
-    gfxPixel(x0-r, y0, color);
+    pixel(x0, y0+r, color);
+    pixel(x0, y0-r, color);
+    pixel(x0+r, y0, color);
+    pixel(x0-r, y0, color);
 
     while (x<y)
     {
@@ -210,34 +919,39 @@ void gfxCircle(int16_t x0, int16_t y0,  // Center coord
         ddF_x += 2;
         f += ddF_x;
   
-        gfxPixel(x0 + x, y0 + y, color);
-        gfxPixel(x0 - x, y0 + y, color);
-        gfxPixel(x0 + x, y0 - y, color);
-        gfxPixel(x0 - x, y0 - y, color);
+        pixel(x0 + x, y0 + y, color);
+        pixel(x0 - x, y0 + y, color);
+        pixel(x0 + x, y0 - y, color);
+        pixel(x0 - x, y0 - y, color);
     
-        gfxPixel(x0 + y, y0 + x, color);
-        gfxPixel(x0 - y, y0 + x, color);
-        gfxPixel(x0 + y, y0 - x, color);
-        gfxPixel(x0 - y, y0 - x, color);
+        pixel(x0 + y, y0 + x, color);
+        pixel(x0 - y, y0 + x, color);
+        pixel(x0 + y, y0 - x, color);
+        pixel(x0 - y, y0 - x, color);
     }
 }
 
-// Filled circle
+// Filled circle (drawn as vertical spans, clipped)
 void gfxFCircle(int16_t x0, int16_t y0, // Center coord
                 int16_t r,               // Radius
                 uint8_t color)
 {
-    uint8_t i;
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+    STAT(GFX_ST_FCIRCLE);
 
-    int8_t f = 1 - r;
-    int8_t ddF_x = 1;
-    int8_t ddF_y = -2 * r;
-    int8_t x = 0;
-    int8_t y = r;
+    RMW_BY_PAGE(y0 - r, y0 + r, color, gfxFCircle(x0, y0, r, color));
 
-    for (i=y0-r; i<=y0+r; i++) {
-        gfxPixel(x0, i, color);
-    }
+    x0 += clip.ox;
+    y0 += clip.oy;
+
+    if(x0 + r < limX0 || x0 - r > limX1 || y0 + r < limY0 || y0 - r > limY1)
+        return;
+
+    vSpan(x0, y0 - r, y0 + r, color);
 
     while (x<y) {
         if (f >= 0) {
@@ -249,14 +963,587 @@ void gfxFCircle(int16_t x0, int16_t y0, // Center coord
         ddF_x += 2;
         f += ddF_x;
   
-        for (i=y0-y; i<=y0+y; i++) {
-            gfxPixel(x0+x, i, color);
-            gfxPixel(x0-x, i, color);
+        vSpan(x0 + x, y0 - y, y0 + y, color);
+        vSpan(x0 - x, y0 - y, y0 + y, color);
+        vSpan(x0 + y, y0 - x, y0 + x, color);
+        vSpan(x0 - y, y0 - x, y0 + x, color);
+    }
+}
+
+//
+// Filled polygon
+//
+// The polygon is scanned a column at a time, so each run of pixels inside
+// it is a vertical span, drawn with byte masks (vSpan). An edge table,
+// sorted by starting column, feeds a list of active edges. Each active
+// edge steps down its column crossings Bresenham-style: whole rows plus a
+// remainder over dx, so the crossings are exact.
+//
+// A pixel is filled if its centre (x,y) is inside (even-odd rule). An
+// edge covers columns x0 <= x < x1, and a span covers rows a <= y < b, so
+// polygons sharing an edge don't overlap.
+//
+typedef struct {
+    int16_t x0, x1;     // Columns covered
+    int16_t y, r;       // Crossing at the current column: y + r/dx
+    int16_t q, rr, dx;  // Step per column: q + rr/dx
+    int16_t y0, dy;     // Start point (column x0), and rise
+} edge_t;
+
+static edge_t edges[GFX_POLY_MAX];
+
+// Put an edge's crossing at column x
+static void edgeAt(edge_t *e, int16_t x)
+{
+    int32_t num = (int32_t)(x - e->x0) * e->dy;
+    int32_t q = num / e->dx;
+
+    if(num % e->dx < 0) q--;        // Round towards -infinity
+    e->y = e->y0 + q;
+    e->r = num - q * e->dx;
+}
+
+void gfxFillPoly(int16_t n, const int16_t *xy, uint8_t color)
+{
+    int16_t i, j, nEdges = 0, nActive, next;
+    int16_t xMin, xMax, yMin, yMax, x, x1;
+    int16_t ax, ay, bx, by;
+    edge_t *active[GFX_POLY_MAX], *e;
+    int16_t cross[GFX_POLY_MAX], c;
+    STAT(GFX_ST_POLY);
+
+    if(n < 3 || n > GFX_POLY_MAX) return;
+
+    xMin = xMax = xy[0];
+    yMin = yMax = xy[1];
+    for(i = 1; i < n; i++)
+    {
+        if(xy[2*i]   < xMin) xMin = xy[2*i];
+        if(xy[2*i]   > xMax) xMax = xy[2*i];
+        if(xy[2*i+1] < yMin) yMin = xy[2*i+1];
+        if(xy[2*i+1] > yMax) yMax = xy[2*i+1];
+    }
+
+    RMW_BY_PAGE(yMin, yMax, color, gfxFillPoly(n, xy, color));
+
+    xMin += clip.ox; xMax += clip.ox;
+    yMin += clip.oy; yMax += clip.oy;
+    if(xMax <= limX0 || xMin > limX1 || yMax <= limY0 || yMin > limY1)
+        return;
+
+    // Edge table: non-vertical edges, left to right, sorted by x0
+    for(i = 0; i < n; i++)
+    {
+        j = i + 1 < n ? i + 1 : 0;
+        ax = xy[2*i] + clip.ox;  ay = xy[2*i+1] + clip.oy;
+        bx = xy[2*j] + clip.ox;  by = xy[2*j+1] + clip.oy;
+        if(ax == bx) continue;
+        if(ax > bx) {
+            swap(ax, bx);
+            swap(ay, by);
         }
-        for (i=y0-x; i<=y0+x; i++) {
-            gfxPixel(x0+y, i, color);
-            gfxPixel(x0-y, i, color);
+
+        for(j = nEdges; j > 0 && edges[j-1].x0 > ax; j--)
+            edges[j] = edges[j-1];
+        e = &edges[j];
+        e->x0 = ax;
+        e->x1 = bx;
+        e->y0 = ay;
+        e->dy = by - ay;
+        e->dx = bx - ax;
+        e->q = e->dy / e->dx;
+        e->rr = e->dy % e->dx;
+        if(e->rr < 0) {
+            e->q--;
+            e->rr += e->dx;
+        }
+        nEdges++;
+    }
+
+    x = xMin > limX0 ? xMin : limX0;
+    x1 = xMax <= limX1 ? xMax - 1 : limX1;
+    nActive = 0;
+    next = 0;
+
+    for(; x <= x1; x++)
+    {
+        // Drop edges that end here, step the rest
+        for(i = j = 0; i < nActive; i++)
+        {
+            e = active[i];
+            if(e->x1 <= x) continue;
+            e->y += e->q;
+            e->r += e->rr;
+            if(e->r >= e->dx) {
+                e->y++;
+                e->r -= e->dx;
+            }
+            active[j++] = e;
+        }
+        nActive = j;
+
+        // Add edges that start here (or before, if clipped on the left)
+        for(; next < nEdges && edges[next].x0 <= x; next++)
+        {
+            e = &edges[next];
+            if(e->x1 <= x) continue;
+            edgeAt(e, x);
+            active[nActive++] = e;
+        }
+
+        // First row at or below each crossing, sorted, then fill in pairs
+        for(i = 0; i < nActive; i++)
+        {
+            c = active[i]->y + (active[i]->r > 0);
+            for(j = i; j > 0 && cross[j-1] > c; j--)
+                cross[j] = cross[j-1];
+            cross[j] = c;
+        }
+        for(i = 0; i + 1 < nActive; i += 2)
+            if(cross[i] < cross[i+1])
+                vSpan(x, cross[i], cross[i+1] - 1, color);
+    }
+}
+
+// Filled triangle (see gfxFillPoly)
+void gfxFillTriangle(int16_t x0, int16_t y0,
+                     int16_t x1, int16_t y1,
+                     int16_t x2, int16_t y2,
+                     uint8_t color)
+{
+    int16_t xy[6];
+
+    xy[0] = x0; xy[1] = y0;
+    xy[2] = x1; xy[3] = y1;
+    xy[4] = x2; xy[5] = y2;
+    gfxFillPoly(3, xy, color);
+}
+
+
+//
+// Batched points and polylines
+//
+// Drawing a point at a time costs a call, the RMW check, the origin and
+// clip, and (without a bitmap) a read-modify-write of a byte that its
+// neighbours are likely to hit again. These take the lot in one call:
+// with a bitmap, the points go straight in, and the changed columns of
+// each page are gathered up and reported once at the end. In RMW mode,
+// the points are bucketed by page, and each page's masks are merged
+// before going to the LCD, so every byte touched is modified just once.
+// (gfxPolyline's lines take a pass per page, as other primitives do.)
+//
+
+#define SPAN_PAGES 16      // Pages of changed columns tracked (64x128)
+#define RMW_CHUNK  256     // Points sorted by page, at most, in RMW mode
+
+void gfxSetSpanHook(void (*hook)(int16_t page, int16_t col0, int16_t col1))
+{
+    spanHook = hook;
+}
+
+// Y extent of a list of points
+static void yRange(int16_t n, const int16_t *xy, int16_t *yMin, int16_t *yMax)
+{
+    int16_t i;
+
+    *yMin = INT16_MAX;
+    *yMax = INT16_MIN;
+    for(i = 0; i < n; i++) {
+        if(xy[2*i+1] < *yMin) *yMin = xy[2*i+1];
+        if(xy[2*i+1] > *yMax) *yMax = xy[2*i+1];
+    }
+}
+
+// Report the columns first[p]..last[p] of each page p that has any
+static void reportSpans(const int16_t *first, const int16_t *last)
+{
+    int16_t p;
+
+    if(!bmap || !spanHook) return;
+    for(p = 0; p < SPAN_PAGES; p++)
+        if(first[p] <= last[p])
+            spanHook(p, first[p], last[p]);
+}
+
+// One of gfxPlotPoints' points, if it's within the limits
+static void plotPoint(const int16_t *xy, uint8_t color)
+{
+    int16_t x = xy[0] + clip.ox, y = xy[1] + clip.oy;
+
+    if(x >= limX0 && x <= limX1 && y >= limY0 && y <= limY1)
+        putMask(y >> 3, x, 0x80 >> (y & 7), color);
+}
+
+// gfxPlotPoints in RMW mode. The points are counted per page, in one pass,
+// and up to RMW_CHUNK of them are sorted by page as well (a counting
+// sort), so each page with any takes just its own. More than that, and
+// each such page takes a pass over them all; either way, each page goes
+// to the LCD once.
+static void plotPointsRmw(int16_t n, const int16_t *xy, uint8_t color)
+{
+    static uint8_t order[RMW_CHUNK];    // The points, by page
+    int16_t count[SPAN_PAGES], end[SPAN_PAGES];
+    int16_t i, k, y, page;
+
+    // (limY is within the panel's pages here)
+    memset(count, 0, sizeof(count));
+    for(k = 0; k < n; k++) {
+        y = xy[2*k+1] + clip.oy;
+        if(y >= limY0 && y <= limY1) count[y >> 3]++;
+    }
+    for(page = 0, i = 0; page < SPAN_PAGES; i += count[page++])
+        end[page] = i;                  // (Where page's points start...
+    if(n <= RMW_CHUNK)
+        for(k = 0; k < n; k++) {
+            y = xy[2*k+1] + clip.oy;
+            if(y >= limY0 && y <= limY1)
+                order[end[y >> 3]++] = k;   // ...until placed)
+        }
+
+    for(page = 0; page < SPAN_PAGES; page++)
+    {
+        if(!count[page]) continue;
+        rmwBegin(page);
+        if(n <= RMW_CHUNK)
+            for(i = end[page] - count[page]; i < end[page]; i++)
+                plotPoint(&xy[2 * order[i]], color);
+        else
+            for(k = 0; k < n; k++)      // (Other pages' are clipped)
+                plotPoint(&xy[2 * k], color);
+        rmwEnd(color);
+    }
+}
+
+void gfxPlotPoints(int16_t n, const int16_t *xy, uint8_t color)
+{
+    int16_t i, x, y, page;
+    int16_t first[SPAN_PAGES], last[SPAN_PAGES];
+    STAT(GFX_ST_POINTS);
+
+    if(n <= 0) return;
+    if(!bmap && rmwPage < 0) {
+        plotPointsRmw(n, xy, color);
+        return;
+    }
+
+    for(page = 0; page < SPAN_PAGES; page++) {
+        first[page] = INT16_MAX;
+        last[page] = -1;
+    }
+
+    for(i = 0; i < n; i++, xy += 2)
+    {
+        x = xy[0] + clip.ox;
+        y = xy[1] + clip.oy;
+        if(x < limX0 || x > limX1 || y < limY0 || y > limY1) continue;
+
+        page = y >> 3;
+        putMask(page, x, 0x80 >> (y & 7), color);
+        if(page < SPAN_PAGES) {
+            if(x < first[page]) first[page] = x;
+            if(x > last[page])  last[page] = x;
+        }
+    }
+    reportSpans(first, last);
+}
+
+void gfxPolyline(int16_t n, const int16_t *xy, uint8_t color)
+{
+    int16_t i, page, x0, x1, yMin, yMax;
+    int16_t first[SPAN_PAGES], last[SPAN_PAGES];
+    STAT(GFX_ST_POLYLINE);
+
+    if(n <= 0) return;
+    yRange(n, xy, &yMin, &yMax);
+    RMW_BY_PAGE(yMin, yMax, color, gfxPolyline(n, xy, color));
+
+    // (In an RMW pass, these just add to the page's masks)
+    for(i = 1; i < n; i++)
+        gfxLine(xy[2*i-2], xy[2*i-1], xy[2*i], xy[2*i+1], color);
+    gfxPixel(xy[2*n-2], xy[2*n-1], color);  // gfxLine leaves out the end
+
+    if(!bmap || !spanHook) return;
+
+    // Changed columns: each segment's box, clipped
+    for(page = 0; page < SPAN_PAGES; page++) {
+        first[page] = INT16_MAX;
+        last[page] = -1;
+    }
+    for(i = 0; i < n; i++)
+    {
+        x0 = x1 = xy[2*i] + clip.ox;
+        yMin = yMax = xy[2*i+1] + clip.oy;
+        if(i + 1 < n) {
+            x1 = xy[2*i+2] + clip.ox;
+            if(x1 < x0) swap(x0, x1);
+            if(xy[2*i+3] + clip.oy < yMin) yMin = xy[2*i+3] + clip.oy;
+            else yMax = xy[2*i+3] + clip.oy;
+        }
+        if(x0 < limX0) x0 = limX0;
+        if(x1 > limX1) x1 = limX1;
+        if(yMin < limY0) yMin = limY0;
+        if(yMax > limY1) yMax = limY1;
+        if(x0 > x1 || yMin > yMax) continue;
+
+        for(page = yMin >> 3; page <= yMax >> 3 && page < SPAN_PAGES; page++) {
+            if(x0 < first[page]) first[page] = x0;
+            if(x1 > last[page])  last[page] = x1;
+        }
+    }
+    reportSpans(first, last);
+}
+
+
+//
+// Scrolling
+//
+// The region's bytes are moved in place: page rows are moved sideways with
+// memmove, and columns up or down by pairs of bytes from adjacent pages,
+// shifted as 16-bit words. Region edges that fall inside a page are
+// handled with masks; the rest of those pages is left as it was.
+//
+
+// A page's row of bytes, as a vertical scroll reads it: the rows of the
+// page outside the region (rowMask) read as the fill, so the bytes are
+// (row[x] & *m) | *f.
+static const uint8_t *scrollSrc(int16_t page, int16_t pTop, int16_t pBot,
+                                uint8_t fillByte, uint8_t *m, uint8_t *f)
+{
+    if(page < pTop || page > pBot) {
+        *m = 0;
+        *f = fillByte;
+        return bmap;            // (Any row will do, it's all masked out)
+    }
+    *m = rowMask(page);
+    *f = fillByte & ~*m;
+    return &bmap[(page - bandPage) * bmapWidth];
+}
+
+// Move the rows of a page sideways by dx, within columns x0..x1
+static void scrollRow(int16_t page, int16_t x0, int16_t x1, int16_t dx,
+                      uint8_t fillByte)
+{
+    uint8_t *row = &bmap[(page - bandPage) * bmapWidth];
+    uint8_t m = rowMask(page), b;
+    int16_t n = x1 - x0 + 1, keep = n - (dx < 0 ? -dx : dx), x;
+
+    if(keep < 0) keep = 0;
+
+    if(m == 0xff)               // Whole page: just move the bytes
+    {
+        if(dx > 0) {
+            memmove(&row[x0 + dx], &row[x0], keep);
+            memset(&row[x0], fillByte, n - keep);
+        } else {
+            memmove(&row[x0], &row[x0 - dx], keep);
+            memset(&row[x0 + keep], fillByte, n - keep);
+        }
+        return;
+    }
+
+    // Part of the page: only the rows in the mask. In the direction of the
+    // move, so each byte is read before it's overwritten.
+    if(dx > 0) {
+        for(x = x1; x >= x0; x--) {
+            b = x - dx >= x0 ? row[x - dx] : fillByte;
+            row[x] = (row[x] & ~m) | (b & m);
+        }
+    } else {
+        for(x = x0; x <= x1; x++) {
+            b = x - dx <= x1 ? row[x - dx] : fillByte;
+            row[x] = (row[x] & ~m) | (b & m);
+        }
+    }
+}
+
+void gfxScrollRegion(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                     int16_t dx, int16_t dy, uint8_t fill)
+{
+    uint8_t fillByte = fill ? 0xff : 0x00, m, sh, mHi, fHi, mLo, fLo;
+    int16_t page, pTop, pBot, step, hi, lo, x, k;
+    const uint8_t *rHi, *rLo;
+    uint16_t w;
+    uint8_t *p;
+    STAT(GFX_ST_SCROLL);
+
+    if(!bmap || (!dx && !dy)) return;
+
+    if(x0 > x1) swap(x0, x1);
+    if(y0 > y1) swap(y0, y1);
+    x0 += clip.ox; x1 += clip.ox;
+    y0 += clip.oy; y1 += clip.oy;
+    if(x0 < limX0) x0 = limX0;
+    if(x1 > limX1) x1 = limX1;
+    if(y0 < limY0) y0 = limY0;
+    if(y1 > limY1) y1 = limY1;
+    if(x0 > x1 || y0 > y1) return;
+
+    pTop = y0 / 8;
+    pBot = y1 / 8;
+    STAT_BYTES((uint32_t)(x1 - x0 + 1) * (pBot - pTop + 1));
+
+    // rowMask() gives the region's rows of a page, with the limits
+    // narrowed to it
+    limY0 = y0;
+    limY1 = y1;
+
+    if(dx)
+        for(page = pTop; page <= pBot; page++)
+            scrollRow(page, x0, x1, dx, fillByte);
+
+    if(dy)
+    {
+        // Page p takes its rows from pages hi and lo (hi above lo) of the
+        // old image, shifted together by sh. Down: work up from the
+        // bottom, up: down from the top, so sources are read first.
+        k = (dy < 0 ? -dy : dy) / 8;
+        if(dy > 0) {
+            page = pBot;
+            step = -1;
+            hi = -k - 1;
+            lo = -k;
+            sh = dy & 7;
+        } else {
+            page = pTop;
+            step = 1;
+            hi = k;
+            lo = k + 1;
+            sh = 8 - (-dy & 7);
+        }
+
+        for(; page >= pTop && page <= pBot; page += step)
+        {
+            rHi = scrollSrc(page + hi, pTop, pBot, fillByte, &mHi, &fHi);
+            rLo = scrollSrc(page + lo, pTop, pBot, fillByte, &mLo, &fLo);
+            m = rowMask(page);
+            p = &bmap[(page - bandPage) * bmapWidth];
+            for(x = x0; x <= x1; x++)
+            {
+                w = ((rHi[x] & mHi) | fHi) << 8 | ((rLo[x] & mLo) | fLo);
+                p[x] = (p[x] & ~m) | ((w >> sh) & m);
+            }
+        }
+    }
+
+    setLimits();
+
+    if(spanHook)
+        for(page = pTop; page <= pBot; page++)
+            spanHook(page, x0, x1);
+}
+
+//
+// Pattern fills
+//
+// As gfxFRect, gfxFCircle and gfxFillPoly, through an 8x8 tile (see
+// gfxPattern.h): the tile's bytes are ANDed into each byte-wide mask, so
+// patterns cost no more than solid fills. The tile is anchored at the
+// pattern origin, so neighbouring fills line up.
+//
+
+// Load the tile (inverted, if invert is 0xff), turned to the origin
+static void patBegin(const uint8_t *tile, uint8_t invert)
+{
+    uint8_t i, b, s = patY & 7;
+
+    for(i = 0; i < 8; i++)
+    {
+        b = tile[i] ^ invert;
+        if(s) b = (b >> s) | (b << (8 - s));
+        patRow[(i + patX) & 7] = b;
+    }
+    patOn = 1;
+}
+
+void gfxPatternOrigin(int16_t x, int16_t y)
+{
+    patX = x + clip.ox;
+    patY = y + clip.oy;
+}
+
+void gfxPatFRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                 const uint8_t *tile, uint8_t color)
+{
+    if(color == GFX_PAT_OPAQUE) {   // Clear the gaps, then set the tile
+        patBegin(tile, 0xff);
+        gfxFRect(x0, y0, x1, y1, 0);
+        color = 1;
+    }
+    patBegin(tile, 0);
+    gfxFRect(x0, y0, x1, y1, color);
+    patOn = 0;
+}
+
+void gfxPatFCircle(int16_t x0, int16_t y0, int16_t r,
+                   const uint8_t *tile, uint8_t color)
+{
+    if(color == GFX_PAT_OPAQUE) {
+        patBegin(tile, 0xff);
+        gfxFCircle(x0, y0, r, 0);
+        color = 1;
+    }
+    patBegin(tile, 0);
+    gfxFCircle(x0, y0, r, color);
+    patOn = 0;
+}
+
+void gfxPatFillPoly(int16_t n, const int16_t *xy,
+                    const uint8_t *tile, uint8_t color)
+{
+    if(color == GFX_PAT_OPAQUE) {
+        patBegin(tile, 0xff);
+        gfxFillPoly(n, xy, 0);
+        color = 1;
+    }
+    patBegin(tile, 0);
+    gfxFillPoly(n, xy, color);
+    patOn = 0;
+}
+
+#ifdef GFX_STATS
+
+void gfxStatsReset(void)
+{
+    memset(stats, 0, sizeof(stats));
+}
+
+void gfxStatsSnapshot(gfxStat_t *st)
+{
+    memcpy(st, stats, sizeof(stats));
+}
+
+void gfxStatsDump(void)
+{
+    char line[80];
+    gfxStat_t *st;
+    uint8_t id, b;
+    int n;
+
+    DBPUTS("prim        calls     bytes    pixels     ticks  mean\n");
+    for(id = 0; id < GFX_ST_COUNT; id++)
+    {
+        st = &stats[id];
+        if(!st->calls) continue;
+
+        sprintf(line, "%-10s %6lu %9lu %9lu %9lu %5lu\n", statName[id],
+                (unsigned long)st->calls, (unsigned long)st->bytes,
+                (unsigned long)st->pixels, (unsigned long)st->ticks,
+                (unsigned long)(st->ticks / st->calls));
+        DBPUTS(line);
+
+        // Histogram, on a line of its own
+        n = sprintf(line, "          ");
+        for(b = 0; b < GFX_ST_BUCKETS; b++)
+        {
+            if(!st->hist[b]) continue;
+            if(n > (int)sizeof(line) - 16) {    // Full: wrap
+                DBPUTS(strcat(line, "\n"));
+                n = sprintf(line, "          ");
+            }
+            n += sprintf(line + n, " %u:%lu", b, (unsigned long)st->hist[b]);
         }
+        DBPUTS(strcat(line, "\n"));
     }
 }
 
+#endif
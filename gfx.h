@@ -10,16 +10,55 @@
 // with the ST7565 LCD controller.
 //
 // TODOs: - Allow for other pixel mapping arrangements.
-//        - Provide a *.bmp translation util.
+//
+// Images (*.pbm, *.bmp) can be converted with tools/pbm2img; see gfxImage.h.
 
 // gfxInit - Init some variables that the graphics routines
 //           will need. Note the bitmapBuffer size is assumed to
 //           be bitmapWidth * bitmapHeight / 8.
+//           With a NULL buffer, drawing goes straight to the selected
+//           panel's display RAM, unrotated and within its columns and
+//           pages, by read-modify-write. That needs the parallel bus: on a
+//           serial one, drawn bytes replace what the LCD showed.
 //
 void gfxInit(int16_t bitmapWidth,    // Width  (pixels)
              int16_t bitmapHeight,   // Height (pixels)
              uint8_t  *bitmapBuffer); // Bitmap buffer
 
+// gfxInitBand - As gfxInit, but the buffer holds only nPages pages of the
+//               bitmap, starting at firstPage (e.g. a single 128-byte page
+//               band), and it is not cleared. Drawing outside the band is
+//               discarded.
+//
+void gfxInitBand(int16_t bitmapWidth, int16_t bitmapHeight,
+                 uint8_t *band, int16_t firstPage, int16_t nPages);
+
+// gfxGetBand - The bitmap (or band) being drawn in, as gfxInitBand takes
+//              it, so code that borrows gfx can put it back as it was.
+//
+void gfxGetBand(int16_t *bitmapWidth, int16_t *bitmapHeight,
+                uint8_t **band, int16_t *firstPage, int16_t *nPages);
+
+// Clip rectangle / viewport stack
+//
+// Drawing is clipped to the intersection of the rectangles pushed (and the
+// bitmap). gfxPushClip takes x0,y0..x1,y1 (inclusive) in the current
+// coordinates; gfxPushViewport also moves the origin to x0,y0, so a widget
+// can draw itself in local coordinates. Each push is undone by gfxPopClip.
+// Pushes beyond GFX_CLIP_DEPTH are ignored. gfxInit empties the stack.
+//
+// Primitives that fall wholly outside the clip are rejected before any
+// pixel work, and partly visible ones are clipped up front, so pixels
+// inside come out exactly as they would unclipped. gfxFill is not clipped.
+//
+#ifndef GFX_CLIP_DEPTH
+#define GFX_CLIP_DEPTH 4
+#endif
+
+void gfxPushClip(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+void gfxPushViewport(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+void gfxPopClip(void);
+
 // The remainder of the routines will work on the bitmap buffer
 // that is supplied in the call to initGfx. Most routines accept
 // one or more x,y locations, and a color, where the color is
@@ -48,12 +87,126 @@ void gfxCircle(int16_t x0, int16_t y0,
 void gfxFCircle(int16_t x0, int16_t y0,
                 int16_t r, uint8_t color);
 
+// Filled polygon: n vertices (3..GFX_POLY_MAX), as x,y pairs in xy[].
+// Pixels whose centres are inside (even-odd rule) are filled; the right
+// and bottom edges are left out, so polygons sharing an edge don't overlap.
+// Concave and self-intersecting polygons are fine.
+#ifndef GFX_POLY_MAX
+#define GFX_POLY_MAX 16
+#endif
+
+void gfxFillPoly(int16_t n, const int16_t *xy, uint8_t color);
+
+void gfxFillTriangle(int16_t x0, int16_t y0,
+                     int16_t x1, int16_t y1,
+                     int16_t x2, int16_t y2,
+                     uint8_t color);
+
+// Batched drawing: n points, as x,y pairs in xy[], plotted in one go, and
+// a polyline joining n points with lines. Much cheaper than a gfxPixel or
+// gfxLine per point; without a bitmap (RMW), each LCD byte is modified
+// once however many points land in it.
+void gfxPlotPoints(int16_t n, const int16_t *xy, uint8_t color);
+void gfxPolyline(int16_t n, const int16_t *xy, uint8_t color);
+
+// Have gfxPlotPoints and gfxPolyline report the columns they change in
+// the bitmap, a span per page, e.g. gfxSetSpanHook(gfxDamageSpan) to add
+// them to the damage for gfxDamageFlush. NULL to stop.
+void gfxSetSpanHook(void (*hook)(int16_t page, int16_t col0, int16_t col1));
+
+// Scroll the contents of a rectangle (x0,y0..x1,y1, inclusive) by dx,dy
+// pixels (right and down if positive), in place in the bitmap. What moves
+// out of the rectangle is lost; what's uncovered is set to fill (0 or 1).
+// Clipped: the rectangle is cut to the clip first, so nothing outside the
+// clip moves in or is changed. The columns changed go to the span hook,
+// as for gfxPlotPoints. Needs a bitmap buffer; does nothing without one.
+// In a band (gfxInitBand), works on the part in the band only.
+void gfxScrollRegion(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                     int16_t dx, int16_t dy, uint8_t fill);
+
+// Pattern fills: as gfxFRect, gfxFCircle and gfxFillPoly, through an 8x8
+// tile (see gfxPattern.h for the layout and a library of tiles).
+// color 1 sets the tile's pixels, 0 clears them (e.g. to gray out a
+// disabled widget), and GFX_PAT_OPAQUE sets them and clears the rest.
+// Tiles are anchored at the pattern origin: 0,0 after gfxInit, or as set
+// by gfxPatternOrigin (in the current coordinates).
+#define GFX_PAT_OPAQUE 2
+
+void gfxPatternOrigin(int16_t x, int16_t y);
+
+void gfxPatFRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                 const uint8_t *tile, uint8_t color);
+void gfxPatFCircle(int16_t x0, int16_t y0, int16_t r,
+                   const uint8_t *tile, uint8_t color);
+void gfxPatFillPoly(int16_t n, const int16_t *xy,
+                    const uint8_t *tile, uint8_t color);
+
 // These char and string routines plot 5x7 pixel characters at an x location
 // (specified in pixels) and y location (specified in lines).
 // Lines are 8 pixels high (one pixel spacing between 5x7 font).
+// In a viewport whose origin isn't on a page boundary, lines are counted
+// from the origin.
+// Strings are UTF-8; a char given to gfxChar is a CP437 byte (ASCII in a
+// subset font), and gfxCharU takes a code point. Characters the font lacks
+// show as '?' (see gfxFont.h for fonts and their Unicode coverage).
 void gfxChar(int16_t x,    // x location (in pixels)
              int16_t line, // y location (in 8-pixel lines)
              char c);       // The char to print
+void gfxCharU(int16_t x, int16_t line, uint16_t codePoint);
 void gfxString(int16_t x, int16_t line, char *c);
 
+// Number of characters (not bytes) in a UTF-8 string
+int16_t gfxTextLen(const char *c);
+
+// Text scaled up 1..4 times (e.g. for large readouts): each font pixel
+// becomes scale x scale pixels; characters are 6*scale pixels apart. Here
+// y is in pixels, and needn't be on a line. No wrapping; clipped.
+void gfxBigChar(int16_t x, int16_t y, char c, uint8_t scale);
+void gfxBigString(int16_t x, int16_t y, char *c, uint8_t scale);
+
+// Copy a page-format image, w pixels wide by pages*8 pixels high, to
+// x (in pixels) and line (in 8-pixel lines).
+void gfxBitmap(int16_t x, int16_t line,
+               int16_t w, int16_t pages, const uint8_t *img);
+
+// Instrumentation: build with GFX_STATS defined to count, per primitive,
+// the calls, the bitmap (or LCD) bytes and pixels they touch, and the time
+// they take, in core timer ticks (see tickNow), with a histogram of call
+// times in log2 buckets (bucket b: 2^b up to 2^(b+1) ticks; the last one
+// takes everything longer). Without GFX_STATS, none of this is compiled.
+//
+// A primitive's time includes any it calls (e.g. gfxRect's lines, or
+// gfxString's chars); bytes and pixels are counted against the innermost.
+// Counters are 32 bits; reset them before each measurement.
+//
+#ifdef GFX_STATS
+
+enum {
+    GFX_ST_FILL, GFX_ST_PIXEL, GFX_ST_LINE, GFX_ST_RECT, GFX_ST_FRECT,
+    GFX_ST_CIRCLE, GFX_ST_FCIRCLE, GFX_ST_POLY, GFX_ST_CHAR, GFX_ST_STRING,
+    GFX_ST_BIGTEXT, GFX_ST_BITMAP, GFX_ST_POINTS, GFX_ST_POLYLINE,
+    GFX_ST_SCROLL, GFX_ST_COUNT
+};
+
+#define GFX_ST_BUCKETS 16
+
+typedef struct {
+    uint32_t calls;
+    uint32_t bytes;                 // Bytes written, and...
+    uint32_t pixels;                //   the pixels written in them
+    uint32_t ticks;                 // Total time
+    uint32_t hist[GFX_ST_BUCKETS];  // Calls by time, log2 buckets
+} gfxStat_t;
+
+void gfxStatsReset(void);
+
+// Copy the counters (GFX_ST_COUNT of them, by GFX_ST_ id) to st[]
+void gfxStatsSnapshot(gfxStat_t *st);
+
+// Print a line per primitive called, through DBPUTS: calls, bytes, pixels,
+// total and mean ticks, then the non-empty histogram buckets as b:count.
+void gfxStatsDump(void);
+
+#endif
+
 #endif
@@ -0,0 +1,103 @@
+//
+// gfxDamage.c - Dirty region tracking and partial LCD flushes
+//
+
+#include <stdint.h>
+
+#include "gfxDamage.h"
+#include "st7565.h"
+
+//
+// Private variables
+//
+static int16_t dmgMin[GFX_DAMAGE_PAGES];   // First changed column per page
+static int16_t dmgEnd[GFX_DAMAGE_PAGES];   // Last changed column + 1; 0: none
+
+
+// The display's bitmap size, as lcdWriteBuffer takes it now, in pixels
+// wide and pages high (at most GFX_DAMAGE_PAGES)
+static void dispSize(int16_t *width, int16_t *pages)
+{
+    int16_t height;
+
+    lcdGetSize(width, &height);
+    *pages = height / 8;
+    if(*pages > GFX_DAMAGE_PAGES) *pages = GFX_DAMAGE_PAGES;
+}
+
+void gfxDamageSpan(int16_t page, int16_t col0, int16_t col1)
+{
+    int16_t width, pages;
+
+    dispSize(&width, &pages);
+    if(page < 0 || page >= pages) return;
+    if(col0 < 0) col0 = 0;
+    if(col1 >= width) col1 = width - 1;
+    if(col0 > col1) return;
+
+    if(!dmgEnd[page] || col0 < dmgMin[page]) dmgMin[page] = col0;
+    if(col1 >= dmgEnd[page]) dmgEnd[page] = col1 + 1;
+}
+
+void gfxDamageRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    int16_t t, page, width, pages;
+
+    dispSize(&width, &pages);
+    if(x0 > x1) { t = x0; x0 = x1; x1 = t; }
+    if(y0 > y1) { t = y0; y0 = y1; y1 = t; }
+    if(y1 < 0 || y0 >= pages * 8) return;
+    if(y0 < 0) y0 = 0;
+    if(y1 >= pages * 8) y1 = pages * 8 - 1;
+
+    for(page = y0 / 8; page <= y1 / 8; page++)
+        gfxDamageSpan(page, x0, x1);
+}
+
+void gfxDamageAll(void)
+{
+    int16_t page, width, pages;
+
+    dispSize(&width, &pages);
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++) {
+        dmgMin[page] = 0;
+        dmgEnd[page] = page < pages ? width : 0;
+    }
+}
+
+uint8_t gfxDamageGet(int16_t page, int16_t *col0, int16_t *col1)
+{
+    if(page < 0 || page >= GFX_DAMAGE_PAGES || !dmgEnd[page]) return 0;
+    *col0 = dmgMin[page];
+    *col1 = dmgEnd[page] - 1;
+    return 1;
+}
+
+void gfxDamageClear(void)
+{
+    int16_t page;
+
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++)
+        dmgEnd[page] = 0;
+}
+
+uint16_t gfxDamageFlushPage(const uint8_t *buff, int16_t page)
+{
+    uint16_t n;
+
+    if(page < 0 || page >= GFX_DAMAGE_PAGES || !dmgEnd[page]) return 0;
+
+    n = lcdWriteBufferSpan(buff, page, dmgMin[page], dmgEnd[page] - 1);
+    dmgEnd[page] = 0;
+    return n;
+}
+
+uint16_t gfxDamageFlush(const uint8_t *buff)
+{
+    int16_t page;
+    uint16_t sent = 0;
+
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++)
+        sent += gfxDamageFlushPage(buff, page);
+    return sent;
+}
@@ -0,0 +1,54 @@
+#ifndef __GFXDAMAGE_H_
+#define __GFXDAMAGE_H_
+
+#include <stdint.h>
+
+//
+// Damage (dirty region) tracking
+//
+// Records which parts of the bitmap have changed since the last flush, as
+// one span of columns per page, so that only those bytes need be sent to
+// the LCD. Spans are widened to cover each new region, so two small
+// changes at opposite ends of a page flush the whole width between them.
+//
+// Coordinates are those of the bitmap lcdWriteBuffer takes, for the
+// selected panel in its current orientation (e.g. 64x128 in portrait), and
+// flushes are rotated the same way. After changing the orientation, call
+// gfxDamageAll (and redraw) before the next flush.
+//
+// To pace the flushes, rather than flush after every change, see
+// gfxFrame.h.
+//
+
+#define GFX_DAMAGE_PAGES 16  // Pages tracked, at most (64x128 portrait)
+
+// A run of changed columns, col0..col1 (inclusive), in one page
+typedef struct {
+    int16_t page;
+    int16_t col0, col1;
+} gfxSpan_t;
+
+// Mark a rectangle of pixels as changed (inclusive corners, any order;
+// clipped to the display).
+void gfxDamageRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+// Mark columns col0..col1 (inclusive) of one page as changed
+void gfxDamageSpan(int16_t page, int16_t col0, int16_t col1);
+
+// Mark the whole display as changed
+void gfxDamageAll(void);
+
+// Get the changed columns of a page. Returns 0 if it has none.
+uint8_t gfxDamageGet(int16_t page, int16_t *col0, int16_t *col1);
+
+// Forget all changes
+void gfxDamageClear(void);
+
+// Send the changed parts of a bitmap (as for lcdWriteBuffer) to the LCD,
+// and forget them. Returns the number of data bytes sent.
+uint16_t gfxDamageFlush(const uint8_t *buff);
+
+// As gfxDamageFlush, for one page only
+uint16_t gfxDamageFlushPage(const uint8_t *buff, int16_t page);
+
+#endif
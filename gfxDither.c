@@ -0,0 +1,158 @@
+//
+// gfxDither.c - Grayscale to 1bpp page format: Bayer and Floyd-Steinberg
+//
+
+#include <stdint.h>
+#include <string.h>
+
+#include "gfx.h"
+#include "gfxDither.h"
+#include "st7565.h"
+
+// 8x8 Bayer matrix, as thresholds 2..254 (a pixel is on if gray < it)
+static const uint8_t bayer[8][8] = {
+    {   2, 130,  34, 162,  10, 138,  42, 170 },
+    { 194,  66, 226,  98, 202,  74, 234, 106 },
+    {  50, 178,  18, 146,  58, 186,  26, 154 },
+    { 242, 114, 210,  82, 250, 122, 218,  90 },
+    {  14, 142,  46, 174,   6, 134,  38, 166 },
+    { 206,  78, 238, 110, 198,  70, 230, 102 },
+    {  62, 190,  30, 158,  54, 182,  22, 150 },
+    { 254, 126, 222,  94, 246, 118, 214,  86 },
+};
+
+#define H 0x80808080u   // High bit of each byte lane
+
+//
+// Private variables
+//
+static uint8_t method;
+static int16_t width;
+static uint8_t *page;                        // Output page
+static int16_t row;                          // Row of the image, 0..
+static int16_t errCur[GFX_DITHER_MAX_W + 2]; // FS error for this row, and
+static int16_t errNext[GFX_DITHER_MAX_W + 2];//   the next (offset by 1)
+
+
+void gfxDitherBegin(uint8_t _method, int16_t w, uint8_t *_page)
+{
+    method = _method;
+    width = w > GFX_DITHER_MAX_W ? GFX_DITHER_MAX_W : w;
+    page = _page;
+    row = 0;
+    memset(errCur, 0, sizeof(errCur));
+    memset(errNext, 0, sizeof(errNext));
+}
+
+// Bayer: four pixels per 32-bit word. Lane-wise unsigned gray < threshold
+// (Hacker's Delight 2-18), with no branches; each lane's result lands in
+// its high bit.
+static void bayerRow(const uint8_t *gray, uint8_t bit)
+{
+    const uint8_t *thr = bayer[row & 7];
+    uint32_t g, t, z, lt;
+    uint8_t lanes[4];
+    int16_t x, k, n;
+
+    for(x = 0; x < width; x += 4)
+    {
+        n = width - x < 4 ? width - x : 4;
+        g = 0xffffffffu;                     // (Pad lanes: never on)
+        memcpy(&g, &gray[x], n);
+        memcpy(&t, &thr[x & 7], 4);          // (x & 7 is 0 or 4)
+
+        z = (g | H) - (t & ~H);
+        lt = ((~g & t) | (~(g ^ t) & ~z)) & H;
+
+        memcpy(lanes, &lt, 4);
+        for(k = 0; k < n; k++)
+            page[x + k] |= (lanes[k] >> 7) * bit;
+    }
+}
+
+// Floyd-Steinberg, left to right. Errors are carried in errCur/errNext,
+// offset by one so x-1 and x+1 need no edge checks.
+static void fsRow(const uint8_t *gray, uint8_t bit)
+{
+    int16_t x, v, e;
+    int16_t *cur = &errCur[1], *next = &errNext[1];
+
+    for(x = 0; x < width; x++)
+    {
+        v = gray[x] + (cur[x] >> 4);
+        if(v < 128) {            // Dark: pixel on (as black, 0)
+            page[x] |= bit;
+            e = v;
+        }
+        else
+            e = v - 255;
+
+        cur[x + 1]  += e * 7;
+        next[x - 1] += e * 3;
+        next[x]     += e * 5;
+        next[x + 1]  = e;        // (First to touch it this row)
+    }
+
+    memcpy(errCur, errNext, sizeof(errCur));
+    errNext[0] = errNext[1] = 0;
+}
+
+uint8_t gfxDitherRow(const uint8_t *gray)
+{
+    uint8_t bit = 0x80 >> (row & 7);
+
+    if((row & 7) == 0)
+        memset(page, 0, width);  // Starting a new page
+
+    if(method == GFX_DITHER_BAYER) bayerRow(gray, bit);
+    else                           fsRow(gray, bit);
+
+    row++;
+    return (row & 7) == 0;
+}
+
+uint8_t gfxDitherEnd(void)
+{
+    return (row & 7) != 0;
+}
+
+void gfxDitherDraw(uint8_t m, const uint8_t *gray,
+                   int16_t w, int16_t h, int16_t stride,
+                   int16_t x, int16_t line)
+{
+    uint8_t out[GFX_DITHER_MAX_W];
+    uint8_t *buff;
+    int16_t y, bw, bh, first, n;
+
+    // Rows below the bitmap would only be clipped: don't dither them
+    gfxGetBand(&bw, &bh, &buff, &first, &n);
+    if(h > bh - line * 8) h = bh - line * 8;
+
+    gfxDitherBegin(m, w, out);
+    for(y = 0; y < h; y++, gray += stride)
+        if(gfxDitherRow(gray))
+            gfxBitmap(x, line++, width, 1, out);
+    if(gfxDitherEnd())
+        gfxBitmap(x, line, width, 1, out);
+}
+
+void gfxDitherToLcd(uint8_t m, const uint8_t *gray,
+                    int16_t w, int16_t h, int16_t stride,
+                    uint8_t col, uint8_t pg)
+{
+    uint8_t out[GFX_DITHER_MAX_W];
+    lcdPanel_t *panel = lcdSelect(NULL);
+    int16_t y;
+
+    // Stop at the panel's last page
+    lcdSelect(panel);
+    if(pg >= panel->pages) return;
+    if(h > (panel->pages - pg) * 8) h = (panel->pages - pg) * 8;
+
+    gfxDitherBegin(m, w, out);
+    for(y = 0; y < h; y++, gray += stride)
+        if(gfxDitherRow(gray))
+            lcdWriteSpan(pg++, col, out, width);
+    if(gfxDitherEnd())
+        lcdWriteSpan(pg, col, out, width);
+}
@@ -0,0 +1,48 @@
+#ifndef __GFXDITHER_H_
+#define __GFXDITHER_H_
+
+#include <stdint.h>
+
+//
+// Dithering of 8-bit grayscale to the bitmap's 1bpp page format
+//
+// Source pixels are 0 (black) .. 255 (white); dark pixels are turned on.
+// Rows are fed in top to bottom, one at a time. Every 8 rows make one page
+// of output bytes, in the bitmap's format, ready for memcpy / gfxBitmap /
+// lcdWriteSpan. Nothing but the current output page and (for
+// Floyd-Steinberg) two rows of error terms is kept.
+//
+// Also built into the host tool tools/pgm2pbm, for converting assets.
+//
+
+#define GFX_DITHER_MAX_W  132
+
+#define GFX_DITHER_BAYER  0   // 8x8 ordered dither: fast, regular pattern
+#define GFX_DITHER_FS     1   // Floyd-Steinberg error diffusion
+
+// Start a new image, width pixels wide. page[] (width bytes) receives the
+// output pages.
+void gfxDitherBegin(uint8_t method, int16_t width, uint8_t *page);
+
+// Dither the next row. Returns 1 when this row completed a page (page[]
+// is then ready, until the next call), otherwise 0.
+uint8_t gfxDitherRow(const uint8_t *gray);
+
+// After the last row: returns 1 if page[] holds a part-filled last page
+// (rows below the image are off), otherwise 0.
+uint8_t gfxDitherEnd(void);
+
+// Dither a whole image (rows "stride" bytes apart) into the gfx bitmap,
+// at x (pixels) and line (8-pixel lines). Rows below the bitmap are left
+// out.
+void gfxDitherDraw(uint8_t method, const uint8_t *gray,
+                   int16_t w, int16_t h, int16_t stride,
+                   int16_t x, int16_t line);
+
+// As gfxDitherDraw, but straight to the LCD (page order as lcdWriteSpan),
+// down to the selected panel's last page
+void gfxDitherToLcd(uint8_t method, const uint8_t *gray,
+                    int16_t w, int16_t h, int16_t stride,
+                    uint8_t col, uint8_t page);
+
+#endif
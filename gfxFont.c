@@ -0,0 +1,78 @@
+//
+// Font lookup and UTF-8 decoding (see gfxFont.h)
+//
+#include <stdint.h>
+
+#include "gfxFont.h"
+
+const uint8_t *gfxFontGlyph(const gfxFont_t *font, uint16_t cp)
+{
+    const gfxRange_t *r = font->ranges;
+    int16_t lo = 0, hi = font->nRanges - 1, mid;
+
+    // Most text is in the first range (ASCII, in the fonts here)
+    if(cp >= r[0].first && cp <= r[0].last)
+        return &font->glyphs[(r[0].glyph + cp - r[0].first) * 5];
+
+    while(lo <= hi)     // Binary search
+    {
+        mid = (lo + hi) / 2;
+        if(cp < r[mid].first)
+            hi = mid - 1;
+        else if(cp > r[mid].last)
+            lo = mid + 1;
+        else
+            return &font->glyphs[(r[mid].glyph + cp - r[mid].first) * 5];
+    }
+    return &font->glyphs[font->missing * 5];
+}
+
+const uint8_t *gfxFontByte(const gfxFont_t *font, uint8_t c)
+{
+    if(font->cp437)                 // Direct: no index to search
+        return &font->glyphs[c * 5];
+    if(c >= 0x20 && c < 0x7F)
+        return gfxFontGlyph(font, c);
+    return &font->glyphs[font->missing * 5];
+}
+
+uint16_t gfxUtf8Next(const char **s)
+{
+    const uint8_t *p = (const uint8_t *)*s;
+    uint32_t cp, min;
+    uint8_t n, i;
+
+    if(*p < 0x80) {                 // ASCII (or the end)
+        if(*p) (*s)++;
+        return *p;
+    }
+
+    if((*p & 0xE0) == 0xC0) {       // Lead byte: number of bytes to follow
+        cp = *p & 0x1F; n = 1; min = 0x80;
+    }
+    else if((*p & 0xF0) == 0xE0) {
+        cp = *p & 0x0F; n = 2; min = 0x800;
+    }
+    else if((*p & 0xF8) == 0xF0) {
+        cp = *p & 0x07; n = 3; min = 0x10000;
+    }
+    else {                          // Stray continuation byte, or bad lead
+        (*s)++;
+        return GFX_UTF8_BAD;
+    }
+
+    for(i = 1; i <= n; i++)
+    {
+        if((p[i] & 0xC0) != 0x80) { // Cut short (this also stops at the end)
+            *s += i;
+            return GFX_UTF8_BAD;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *s += n + 1;
+
+    // Overlong forms, surrogates, and beyond the BMP
+    if(cp < min || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0xFFFF)
+        return GFX_UTF8_BAD;
+    return cp;
+}
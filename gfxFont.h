@@ -0,0 +1,61 @@
+#ifndef __GFXFONT_H_
+#define __GFXFONT_H_
+
+#include <stdint.h>
+
+//
+// Fonts and UTF-8 text
+//
+// A font is a table of 5x8 glyphs (5 bytes each, most significant bit on
+// top) and a sparse index from Unicode code points (BMP only) to glyphs:
+// a list of ranges of consecutive code points with consecutive glyphs,
+// sorted by code point.
+//
+// gfx draws text in GFX_FONT, gfxFont5x8 (the full IBM CP437 set in
+// gfxFont_5x8.c) unless defined otherwise. To save flash, generate a font
+// holding only the glyphs the program uses, with tools/fontsubset, link
+// that instead of gfxFont_5x8.c, and build with e.g.
+// -DGFX_FONT=fontSubset.
+//
+// gfxFont5x8 is 1280 bytes of glyphs plus an 882-byte index (147 ranges of
+// 6 bytes), about 2.1 KB of flash; a subset of a few dozen glyphs is a
+// fraction of that.
+//
+// Strings are UTF-8. Single chars (gfxChar, gfxBigChar, the console) are
+// bytes, drawn as CP437 characters straight from the glyph table in fonts
+// that hold all 256 in order (cp437 set, as gfxFont5x8 does); in a subset
+// only the printable ASCII bytes are defined.
+//
+
+typedef struct {
+    uint16_t first, last;   // Code points first..last
+    uint16_t glyph;         // Glyph of "first"
+} gfxRange_t;
+
+typedef struct {
+    const uint8_t    *glyphs;
+    const gfxRange_t *ranges;
+    uint16_t          nRanges;
+    uint16_t          missing;    // Glyph for code points not in the font
+    uint8_t           cp437;      // Glyph n is CP437 character n (0..255)
+} gfxFont_t;
+
+extern const gfxFont_t gfxFont5x8;
+
+#define GFX_UTF8_BAD 0xFFFD       // Returned for malformed UTF-8
+
+// Select the font gfx draws text in (NULL: back to GFX_FONT)
+void gfxSetFont(const gfxFont_t *font);
+
+// The glyph (5 bytes) for a code point
+const uint8_t *gfxFontGlyph(const gfxFont_t *font, uint16_t cp);
+
+// The glyph for a byte (a char), as described above
+const uint8_t *gfxFontByte(const gfxFont_t *font, uint8_t c);
+
+// Decode the next character of a UTF-8 string, and step past it.
+// Returns 0 at the end of the string. Malformed sequences, and characters
+// beyond the BMP, give GFX_UTF8_BAD.
+uint16_t gfxUtf8Next(const char **s);
+
+#endif
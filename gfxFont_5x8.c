@@ -264,3 +264,163 @@ const uint8_t font[] = {
   0x00, 0x3C, 0x3C, 0x3C, 0x3C
 };
 
+
+//
+// Unicode index of the font above (see gfxFont.h): where each CP437 glyph
+// sits in Unicode. Control codes (U+0000..U+001F) have no glyphs.
+//
+#include "gfxFont.h"
+
+static const gfxRange_t ranges[] = {
+    { 0x0020, 0x007E, 0x20 },  // ASCII
+    { 0x00A0, 0x00A0, 0xFF },  // No-Break Space
+    { 0x00A1, 0x00A1, 0xAD },  // Inverted Exclamation Mark
+    { 0x00A2, 0x00A3, 0x9B },  // Cent Sign .. Pound Sign
+    { 0x00A5, 0x00A5, 0x9D },  // Yen Sign
+    { 0x00A7, 0x00A7, 0x15 },  // Section Sign
+    { 0x00AA, 0x00AA, 0xA6 },  // Feminine Ordinal Indicator
+    { 0x00AB, 0x00AB, 0xAE },  // Left-Pointing Double Angle Quotation Mark
+    { 0x00AC, 0x00AC, 0xAA },  // Not Sign
+    { 0x00B0, 0x00B0, 0xF8 },  // Degree Sign
+    { 0x00B1, 0x00B1, 0xF1 },  // Plus-Minus Sign
+    { 0x00B2, 0x00B2, 0xFD },  // Superscript Two
+    { 0x00B5, 0x00B5, 0xE6 },  // Micro Sign
+    { 0x00B6, 0x00B6, 0x14 },  // Pilcrow Sign
+    { 0x00B7, 0x00B7, 0xFA },  // Middle Dot
+    { 0x00BA, 0x00BA, 0xA7 },  // Masculine Ordinal Indicator
+    { 0x00BB, 0x00BB, 0xAF },  // Right-Pointing Double Angle Quotation Mark
+    { 0x00BC, 0x00BC, 0xAC },  // Vulgar Fraction One Quarter
+    { 0x00BD, 0x00BD, 0xAB },  // Vulgar Fraction One Half
+    { 0x00BF, 0x00BF, 0xA8 },  // Inverted Question Mark
+    { 0x00C4, 0x00C5, 0x8E },  // Latin Capital Letter A With Diaeresis .. Lati...
+    { 0x00C6, 0x00C6, 0x92 },  // Latin Capital Letter Ae
+    { 0x00C7, 0x00C7, 0x80 },  // Latin Capital Letter C With Cedilla
+    { 0x00C9, 0x00C9, 0x90 },  // Latin Capital Letter E With Acute
+    { 0x00D1, 0x00D1, 0xA5 },  // Latin Capital Letter N With Tilde
+    { 0x00D6, 0x00D6, 0x99 },  // Latin Capital Letter O With Diaeresis
+    { 0x00DC, 0x00DC, 0x9A },  // Latin Capital Letter U With Diaeresis
+    { 0x00DF, 0x00DF, 0xE1 },  // Latin Small Letter Sharp S
+    { 0x00E0, 0x00E0, 0x85 },  // Latin Small Letter A With Grave
+    { 0x00E1, 0x00E1, 0xA0 },  // Latin Small Letter A With Acute
+    { 0x00E2, 0x00E2, 0x83 },  // Latin Small Letter A With Circumflex
+    { 0x00E4, 0x00E4, 0x84 },  // Latin Small Letter A With Diaeresis
+    { 0x00E5, 0x00E5, 0x86 },  // Latin Small Letter A With Ring Above
+    { 0x00E6, 0x00E6, 0x91 },  // Latin Small Letter Ae
+    { 0x00E7, 0x00E7, 0x87 },  // Latin Small Letter C With Cedilla
+    { 0x00E8, 0x00E8, 0x8A },  // Latin Small Letter E With Grave
+    { 0x00E9, 0x00E9, 0x82 },  // Latin Small Letter E With Acute
+    { 0x00EA, 0x00EB, 0x88 },  // Latin Small Letter E With Circumflex .. Latin...
+    { 0x00EC, 0x00EC, 0x8D },  // Latin Small Letter I With Grave
+    { 0x00ED, 0x00ED, 0xA1 },  // Latin Small Letter I With Acute
+    { 0x00EE, 0x00EE, 0x8C },  // Latin Small Letter I With Circumflex
+    { 0x00EF, 0x00EF, 0x8B },  // Latin Small Letter I With Diaeresis
+    { 0x00F1, 0x00F1, 0xA4 },  // Latin Small Letter N With Tilde
+    { 0x00F2, 0x00F2, 0x95 },  // Latin Small Letter O With Grave
+    { 0x00F3, 0x00F3, 0xA2 },  // Latin Small Letter O With Acute
+    { 0x00F4, 0x00F4, 0x93 },  // Latin Small Letter O With Circumflex
+    { 0x00F6, 0x00F6, 0x94 },  // Latin Small Letter O With Diaeresis
+    { 0x00F7, 0x00F7, 0xF6 },  // Division Sign
+    { 0x00F9, 0x00F9, 0x97 },  // Latin Small Letter U With Grave
+    { 0x00FA, 0x00FA, 0xA3 },  // Latin Small Letter U With Acute
+    { 0x00FB, 0x00FB, 0x96 },  // Latin Small Letter U With Circumflex
+    { 0x00FC, 0x00FC, 0x81 },  // Latin Small Letter U With Diaeresis
+    { 0x00FF, 0x00FF, 0x98 },  // Latin Small Letter Y With Diaeresis
+    { 0x0192, 0x0192, 0x9F },  // Latin Small Letter F With Hook
+    { 0x0393, 0x0393, 0xE2 },  // Greek Capital Letter Gamma
+    { 0x0398, 0x0398, 0xE9 },  // Greek Capital Letter Theta
+    { 0x03A3, 0x03A3, 0xE4 },  // Greek Capital Letter Sigma
+    { 0x03A6, 0x03A6, 0xE8 },  // Greek Capital Letter Phi
+    { 0x03A9, 0x03A9, 0xEA },  // Greek Capital Letter Omega
+    { 0x03B1, 0x03B1, 0xE0 },  // Greek Small Letter Alpha
+    { 0x03B4, 0x03B4, 0xEB },  // Greek Small Letter Delta
+    { 0x03B5, 0x03B5, 0xEE },  // Greek Small Letter Epsilon
+    { 0x03C0, 0x03C0, 0xE3 },  // Greek Small Letter Pi
+    { 0x03C3, 0x03C3, 0xE5 },  // Greek Small Letter Sigma
+    { 0x03C4, 0x03C4, 0xE7 },  // Greek Small Letter Tau
+    { 0x03C6, 0x03C6, 0xED },  // Greek Small Letter Phi
+    { 0x2022, 0x2022, 0x07 },  // Bullet
+    { 0x203C, 0x203C, 0x13 },  // Double Exclamation Mark
+    { 0x207F, 0x207F, 0xFC },  // Superscript Latin Small Letter N
+    { 0x20A7, 0x20A7, 0x9E },  // Peseta Sign
+    { 0x2190, 0x2190, 0x1B },  // Leftwards Arrow
+    { 0x2191, 0x2191, 0x18 },  // Upwards Arrow
+    { 0x2192, 0x2192, 0x1A },  // Rightwards Arrow
+    { 0x2193, 0x2193, 0x19 },  // Downwards Arrow
+    { 0x2194, 0x2194, 0x1D },  // Left Right Arrow
+    { 0x2195, 0x2195, 0x12 },  // Up Down Arrow
+    { 0x21A8, 0x21A8, 0x17 },  // Up Down Arrow With Base
+    { 0x2219, 0x2219, 0xF9 },  // Bullet Operator
+    { 0x221A, 0x221A, 0xFB },  // Square Root
+    { 0x221E, 0x221E, 0xEC },  // Infinity
+    { 0x221F, 0x221F, 0x1C },  // Right Angle
+    { 0x2229, 0x2229, 0xEF },  // Intersection
+    { 0x2248, 0x2248, 0xF7 },  // Almost Equal To
+    { 0x2261, 0x2261, 0xF0 },  // Identical To
+    { 0x2264, 0x2264, 0xF3 },  // Less-Than Or Equal To
+    { 0x2265, 0x2265, 0xF2 },  // Greater-Than Or Equal To
+    { 0x2302, 0x2302, 0x7F },  // House
+    { 0x2310, 0x2310, 0xA9 },  // Reversed Not Sign
+    { 0x2320, 0x2321, 0xF4 },  // Top Half Integral .. Bottom Half Integral
+    { 0x2500, 0x2500, 0xC4 },  // Box Drawings Light Horizontal
+    { 0x2502, 0x2502, 0xB3 },  // Box Drawings Light Vertical
+    { 0x250C, 0x250C, 0xDA },  // Box Drawings Light Down And Right
+    { 0x2510, 0x2510, 0xBF },  // Box Drawings Light Down And Left
+    { 0x2514, 0x2514, 0xC0 },  // Box Drawings Light Up And Right
+    { 0x2518, 0x2518, 0xD9 },  // Box Drawings Light Up And Left
+    { 0x251C, 0x251C, 0xC3 },  // Box Drawings Light Vertical And Right
+    { 0x2524, 0x2524, 0xB4 },  // Box Drawings Light Vertical And Left
+    { 0x252C, 0x252C, 0xC2 },  // Box Drawings Light Down And Horizontal
+    { 0x2534, 0x2534, 0xC1 },  // Box Drawings Light Up And Horizontal
+    { 0x253C, 0x253C, 0xC5 },  // Box Drawings Light Vertical And Horizontal
+    { 0x2550, 0x2550, 0xCD },  // Box Drawings Double Horizontal
+    { 0x2551, 0x2551, 0xBA },  // Box Drawings Double Vertical
+    { 0x2552, 0x2553, 0xD5 },  // Box Drawings Down Single And Right Double .. ...
+    { 0x2554, 0x2554, 0xC9 },  // Box Drawings Double Down And Right
+    { 0x2555, 0x2555, 0xB8 },  // Box Drawings Down Single And Left Double
+    { 0x2556, 0x2556, 0xB7 },  // Box Drawings Down Double And Left Single
+    { 0x2557, 0x2557, 0xBB },  // Box Drawings Double Down And Left
+    { 0x2558, 0x2558, 0xD4 },  // Box Drawings Up Single And Right Double
+    { 0x2559, 0x2559, 0xD3 },  // Box Drawings Up Double And Right Single
+    { 0x255A, 0x255A, 0xC8 },  // Box Drawings Double Up And Right
+    { 0x255B, 0x255B, 0xBE },  // Box Drawings Up Single And Left Double
+    { 0x255C, 0x255C, 0xBD },  // Box Drawings Up Double And Left Single
+    { 0x255D, 0x255D, 0xBC },  // Box Drawings Double Up And Left
+    { 0x255E, 0x255F, 0xC6 },  // Box Drawings Vertical Single And Right Double...
+    { 0x2560, 0x2560, 0xCC },  // Box Drawings Double Vertical And Right
+    { 0x2561, 0x2562, 0xB5 },  // Box Drawings Vertical Single And Left Double ...
+    { 0x2563, 0x2563, 0xB9 },  // Box Drawings Double Vertical And Left
+    { 0x2564, 0x2565, 0xD1 },  // Box Drawings Down Single And Horizontal Doubl...
+    { 0x2566, 0x2566, 0xCB },  // Box Drawings Double Down And Horizontal
+    { 0x2567, 0x2568, 0xCF },  // Box Drawings Up Single And Horizontal Double ...
+    { 0x2569, 0x2569, 0xCA },  // Box Drawings Double Up And Horizontal
+    { 0x256A, 0x256A, 0xD8 },  // Box Drawings Vertical Single And Horizontal D...
+    { 0x256B, 0x256B, 0xD7 },  // Box Drawings Vertical Double And Horizontal S...
+    { 0x256C, 0x256C, 0xCE },  // Box Drawings Double Vertical And Horizontal
+    { 0x2580, 0x2580, 0xDF },  // Upper Half Block
+    { 0x2584, 0x2584, 0xDC },  // Lower Half Block
+    { 0x2588, 0x2588, 0xDB },  // Full Block
+    { 0x258C, 0x258C, 0xDD },  // Left Half Block
+    { 0x2590, 0x2590, 0xDE },  // Right Half Block
+    { 0x2591, 0x2593, 0xB0 },  // Light Shade .. Dark Shade
+    { 0x25A0, 0x25A0, 0xFE },  // Black Square
+    { 0x25AC, 0x25AC, 0x16 },  // Black Rectangle
+    { 0x25B2, 0x25B2, 0x1E },  // Black Up-Pointing Triangle
+    { 0x25BA, 0x25BA, 0x10 },  // Black Right-Pointing Pointer
+    { 0x25BC, 0x25BC, 0x1F },  // Black Down-Pointing Triangle
+    { 0x25C4, 0x25C4, 0x11 },  // Black Left-Pointing Pointer
+    { 0x25CB, 0x25CB, 0x09 },  // White Circle
+    { 0x25D8, 0x25D8, 0x08 },  // Inverse Bullet
+    { 0x25D9, 0x25D9, 0x0A },  // Inverse White Circle
+    { 0x263A, 0x263B, 0x01 },  // White Smiling Face .. Black Smiling Face
+    { 0x263C, 0x263C, 0x0F },  // White Sun With Rays
+    { 0x2640, 0x2640, 0x0C },  // Female Sign
+    { 0x2642, 0x2642, 0x0B },  // Male Sign
+    { 0x2660, 0x2660, 0x06 },  // Black Spade Suit
+    { 0x2663, 0x2663, 0x05 },  // Black Club Suit
+    { 0x2665, 0x2666, 0x03 },  // Black Heart Suit .. Black Diamond Suit
+    { 0x266A, 0x266B, 0x0D },  // Eighth Note .. Beamed Eighth Notes
+};
+
+const gfxFont_t gfxFont5x8 = {
+    font, ranges, sizeof(ranges) / sizeof(ranges[0]), '?', 1
+};
@@ -0,0 +1,166 @@
+//
+// gfxFrame.c - Paced, coalesced flushes of the damaged parts of the bitmap
+//
+
+#include <stdint.h>
+
+#include "gfxDamage.h"
+#include "gfxFrame.h"
+#include "p32_utils.h"
+
+#define sWAITING 0x01   // Page has damage, waiting since since[page]
+#define sDUE     0x02   // ...and must be sent by due[page]
+
+//
+// Private variables
+//
+static const uint8_t *fbuff;
+static uint32_t interval;                   // Frame interval (ticks)
+static uint16_t frameMax;                   // Bytes per frame; 0: no limit
+static uint32_t frameStart;                 // When the last frame began
+static uint8_t  state[GFX_DAMAGE_PAGES];
+static uint32_t since[GFX_DAMAGE_PAGES];
+static uint32_t due[GFX_DAMAGE_PAGES];
+
+
+void gfxFrameInit(const uint8_t *buff, uint16_t intervalMs, uint16_t maxBytes)
+{
+    int16_t page;
+
+    fbuff = buff;
+    interval = tickFromMs(intervalMs);
+    frameMax = maxBytes;
+    frameStart = tickNow() - interval;      // First frame can go straight away
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++)
+        state[page] = 0;
+}
+
+// Bring state[] up to date with the damage: time pages newly damaged, and
+// forget those flushed (by whoever)
+static void stamp(void)
+{
+    int16_t page, c0, c1;
+
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++)
+    {
+        if(!gfxDamageGet(page, &c0, &c1))
+            state[page] = 0;
+        else if(!state[page]) {
+            state[page] = sWAITING;
+            since[page] = tickNow();
+        }
+    }
+}
+
+static uint16_t flushPage(int16_t page)
+{
+    state[page] = 0;
+    return gfxDamageFlushPage(fbuff, page);
+}
+
+void gfxFrameInvalidate(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    gfxDamageRect(x0, y0, x1, y1);
+    stamp();
+}
+
+void gfxFrameInvalidateBy(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                          uint16_t deadlineMs)
+{
+    uint32_t by = tickNow() + tickFromMs(deadlineMs);
+    int16_t t, page;
+
+    gfxFrameInvalidate(x0, y0, x1, y1);
+
+    if(y0 > y1) { t = y0; y0 = y1; y1 = t; }
+    if(y1 < 0 || y0 >= GFX_DAMAGE_PAGES * 8) return;
+    if(y0 < 0) y0 = 0;
+    if(y1 >= GFX_DAMAGE_PAGES * 8) y1 = GFX_DAMAGE_PAGES * 8 - 1;
+
+    for(page = y0 / 8; page <= y1 / 8; page++)
+    {
+        if(!state[page]) continue;          // Nothing there (clipped)
+
+        if(!deadlineMs)
+            flushPage(page);
+        else if(!(state[page] & sDUE) || (int32_t)(by - due[page]) < 0) {
+            state[page] |= sDUE;
+            due[page] = by;
+        }
+    }
+}
+
+// The page whose deadline passed first, or -1 if none has
+static int16_t overdue(void)
+{
+    int16_t page, best = -1;
+
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++)
+    {
+        if(!(state[page] & sDUE) || !tickExpired(due[page])) continue;
+        if(best < 0 || (int32_t)(due[page] - due[best]) < 0) best = page;
+    }
+    return best;
+}
+
+// The page that has waited longest, of those waiting since the frame
+// began, or -1 if none
+static int16_t oldest(void)
+{
+    int16_t page, best = -1;
+
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++)
+    {
+        if(!state[page] || (int32_t)(since[page] - frameStart) > 0) continue;
+        if(best < 0 || (int32_t)(since[page] - since[best]) < 0) best = page;
+    }
+    return best;
+}
+
+// Anything to do: a deadline passed, or a frame due with pages waiting
+static uint8_t ready(void)
+{
+    int16_t page;
+
+    stamp();
+    if(overdue() >= 0) return 1;
+    if(!tickExpired(frameStart + interval)) return 0;
+
+    for(page = 0; page < GFX_DAMAGE_PAGES; page++)
+        if(state[page]) return 1;
+    return 0;
+}
+
+uint8_t gfxFrameTask(task_t *t)
+{
+    static int16_t page, c0, c1;
+    static uint16_t sent;
+
+    TASK_BEGIN(t);
+    while(1)
+    {
+        TASK_WAIT_UNTIL(t, ready());
+
+        // Overdue pages first, on their own
+        if((page = overdue()) >= 0) {
+            flushPage(page);
+            TASK_YIELD(t);
+            continue;
+        }
+
+        // A frame: the pages waiting, longest first, up to frameMax bytes.
+        // Pages damaged during the frame wait for the next.
+        frameStart = tickNow();
+        sent = 0;
+        while((page = oldest()) >= 0)
+        {
+            gfxDamageGet(page, &c0, &c1);
+            if(frameMax && sent && sent + (c1 - c0 + 1) > frameMax) break;
+
+            sent += flushPage(page);
+            TASK_YIELD(t);
+            stamp();
+        }
+    }
+    TASK_END(t);
+}
@@ -0,0 +1,44 @@
+#ifndef __GFXFRAME_H_
+#define __GFXFRAME_H_
+
+#include <stdint.h>
+
+#include "task.h"
+
+//
+// Frame scheduler
+//
+// Rather than flushing the bitmap to the LCD after every change, mark what
+// changed with gfxFrameInvalidate and leave gfxFrameTask to send it. It
+// sends at most one frame per frame interval, however many changes came
+// in between: a burst of updates costs one flush of the pages they
+// touched (the spans, as gfxDamage tracks them), and the bus is free for
+// touch handling etc. in the meantime.
+//
+// A frame can be limited to a number of bytes. Pages go in the order they
+// have waited, longest first, so those left over lead the next frame.
+// Changes that can't wait for the next frame (e.g. a readout tracking a
+// knob) can be given a deadline instead, and their pages are sent as soon
+// as it passes, between frames; deadline 0 sends them there and then.
+//
+// Changes marked with gfxDamageRect etc. directly are sent too, timed
+// from when the scheduler first sees them.
+//
+
+// Start scheduling flushes of buff (as for gfxDamageFlush): a frame at
+// most every intervalMs, of up to maxBytes data bytes (0: no limit; a
+// frame always sends at least one page).
+void gfxFrameInit(const uint8_t *buff, uint16_t intervalMs, uint16_t maxBytes);
+
+// Mark a rectangle (as for gfxDamageRect) to go in the next frame
+void gfxFrameInvalidate(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+// As gfxFrameInvalidate, but send it within deadlineMs, frame or not
+void gfxFrameInvalidateBy(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                          uint16_t deadlineMs);
+
+// Does the flushing; run it from the main loop. Never finishes. It
+// yields after each page sent.
+uint8_t gfxFrameTask(task_t *t);
+
+#endif
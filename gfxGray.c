@@ -0,0 +1,177 @@
+//
+// gfxGray.c - 4-level grayscale by frame-rate control (bitplane sequencing)
+//
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "gfx.h"
+#include "gfxGray.h"
+#include "st7565.h"
+
+#define WIDTH  128   // Landscape only (see gfxGray.h)
+#define HEIGHT  64
+#define PAGES  (HEIGHT / 8)
+
+//
+// Private variables
+//
+static uint8_t *plane[2];     // Bitplanes: level bit 0, level bit 1
+static uint8_t grayPages;     // Bit per page: holds level 1 or 2 pixels
+static uint8_t dirtyPages;    // Bit per page: changed since last sent
+static uint8_t frame;         // Refresh in the 3-refresh cycle, 0..2
+static uint32_t period;       // Ticks per refresh, for gfxGrayService
+static uint32_t nextDue;      // Tick count the next refresh is due at
+
+
+uint8_t gfxGrayInit(uint8_t *plane0, uint8_t *plane1)
+{
+    int16_t w, h;
+
+    lcdGetSize(&w, &h);
+    if(w != WIDTH || h != HEIGHT) {     // Not a layout we can send
+        plane[0] = plane[1] = NULL;
+        return 0;
+    }
+
+    plane[0] = plane0;
+    plane[1] = plane1;
+    memset(plane0, 0, WIDTH * PAGES);
+    memset(plane1, 0, WIDTH * PAGES);
+    grayPages = 0;
+    dirtyPages = 0xff;
+    return 1;
+}
+
+void gfxGrayPixel(int16_t x, int16_t y, uint8_t level)
+{
+    int16_t idx;
+    uint8_t mask;
+
+    if(!plane[0] || x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+
+    idx = y / 8 * WIDTH + x;
+    mask = 0x80 >> (y & 7);
+
+    if(level & 1) plane[0][idx] |= mask;
+    else          plane[0][idx] &= ~mask;
+    if(level & 2) plane[1][idx] |= mask;
+    else          plane[1][idx] &= ~mask;
+
+    dirtyPages |= 1 << (y / 8);
+    if(level == 1 || level == 2)
+        grayPages |= 1 << (y / 8);   // (Cleared by gfxGrayCommit)
+}
+
+// As gfxFill does, a byte at a time: per page, one mask for the rows
+// covered, applied to each column of both planes
+void gfxGrayFRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                  uint8_t level)
+{
+    int16_t x, page;
+    uint8_t mask, *p0, *p1;
+
+    if(!plane[0]) return;
+    if(x0 > x1) { x = x0; x0 = x1; x1 = x; }
+    if(y0 > y1) { x = y0; y0 = y1; y1 = x; }
+    if(x0 < 0) x0 = 0;
+    if(y0 < 0) y0 = 0;
+    if(x1 >= WIDTH) x1 = WIDTH - 1;
+    if(y1 >= HEIGHT) y1 = HEIGHT - 1;
+    if(x0 > x1 || y0 > y1) return;
+
+    for(page = y0 / 8; page <= y1 / 8; page++)
+    {
+        mask = 0xFF;
+        if(page == y0 / 8) mask &= 0xFF >> (y0 & 7);
+        if(page == y1 / 8) mask &= 0xFF << (7 - (y1 & 7));
+
+        p0 = &plane[0][page * WIDTH];
+        p1 = &plane[1][page * WIDTH];
+        for(x = x0; x <= x1; x++)
+        {
+            if(level & 1) p0[x] |= mask;
+            else          p0[x] &= ~mask;
+            if(level & 2) p1[x] |= mask;
+            else          p1[x] &= ~mask;
+        }
+
+        dirtyPages |= 1 << page;
+        if(level == 1 || level == 2)
+            grayPages |= 1 << page;     // (Cleared by gfxGrayCommit)
+    }
+}
+
+void gfxGrayPlane(uint8_t p)
+{
+    if(!plane[0]) return;
+    gfxInitBand(WIDTH, HEIGHT, plane[p & 1], 0, PAGES);
+}
+
+void gfxGrayCommit(void)
+{
+    int16_t page, i;
+    const uint8_t *p0, *p1;
+
+    if(!plane[0]) return;
+    grayPages = 0;
+    for(page = 0; page < PAGES; page++)
+    {
+        p0 = &plane[0][page * WIDTH];
+        p1 = &plane[1][page * WIDTH];
+        for(i = 0; i < WIDTH; i++) {
+            if(p0[i] != p1[i]) {   // Some pixel is level 1 or 2
+                grayPages |= 1 << page;
+                break;
+            }
+        }
+    }
+    dirtyPages = 0xff;
+}
+
+uint8_t gfxGrayRefresh(void)
+{
+    uint8_t row[WIDTH];
+    const uint8_t *p0, *p1;
+    int16_t page, i;
+    uint8_t sent = 0;
+
+    if(!plane[0]) return 0;
+    frame = frame >= 2 ? 0 : frame + 1;
+
+    for(page = 0; page < PAGES; page++)
+    {
+        if(!((grayPages | dirtyPages) & (1 << page))) continue;
+
+        // Levels on this refresh: 1,2,3; then 2,3; then just 3
+        p0 = &plane[0][page * WIDTH];
+        p1 = &plane[1][page * WIDTH];
+        for(i = 0; i < WIDTH; i++) {
+            if(frame == 0)      row[i] = p0[i] | p1[i];
+            else if(frame == 1) row[i] = p1[i];
+            else                row[i] = p0[i] & p1[i];
+        }
+        lcdWriteSpan(page, 0, row, WIDTH);
+        sent++;
+    }
+    dirtyPages = 0;
+    return sent;
+}
+
+void gfxGraySetRate(uint16_t refreshHz, uint32_t ticksPerSec)
+{
+    period = refreshHz ? ticksPerSec / refreshHz : 0;   // 0: stopped
+}
+
+uint8_t gfxGrayService(uint32_t now)
+{
+    if(!period || (int32_t)(now - nextDue) < 0) return 0;
+
+    // Keep to the rate, but don't try to catch up after a long stall
+    nextDue += period;
+    if((int32_t)(now - nextDue) >= 0)
+        nextDue = now + period;
+
+    return gfxGrayRefresh();
+}
@@ -0,0 +1,53 @@
+#ifndef __GFXGRAY_H_
+#define __GFXGRAY_H_
+
+#include <stdint.h>
+
+//
+// Grayscale by frame-rate control
+//
+// Four gray levels (0: off .. 3: fully on) on the 1bpp ST7565, by showing
+// pixels on for 0, 1, 2 or 3 of every 3 refreshes. Refreshes need to come
+// fast enough that they blend (around 150 Hz or more, for a 50 Hz cycle).
+//
+// The image is held as two 128x64 bitplanes, in the usual bitmap format:
+// level = 2 * (plane 1 bit) + (plane 0 bit). Only a 128x64 display in
+// landscape (0 or 180 degrees) is supported, as pages go out with
+// lcdWriteSpan, unrotated; gfxGrayInit refuses anything else. Each refresh
+// sends only the pages that hold levels 1 or 2 (which differ from refresh
+// to refresh), plus any pages changed since the last refresh.
+//
+// Draw with gfxGrayPixel/gfxGrayFRect, or with any gfx routine by selecting
+// a plane (gfxGrayPlane) and drawing with color = that plane's bit of the
+// level, then calling gfxGrayCommit().
+//
+
+// Set the two plane buffers (1 KB each), and clear them. Returns 0 if the
+// display (lcdGetSize) isn't 128x64; the other calls then do nothing.
+uint8_t gfxGrayInit(uint8_t *plane0, uint8_t *plane1);
+
+void gfxGrayPixel(int16_t x, int16_t y, uint8_t level);
+void gfxGrayFRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                  uint8_t level);
+
+// Point the gfx routines at plane 0 or 1
+void gfxGrayPlane(uint8_t plane);
+
+// After drawing on the planes with gfx routines: work out which pages hold
+// gray, and send every page on the next refresh
+void gfxGrayCommit(void);
+
+// Send the next refresh: pages with gray in them, and changed pages.
+// Returns the number of pages sent.
+uint8_t gfxGrayRefresh(void);
+
+// Timer-driven refresh: set a refresh rate, in refreshes per second
+// given the rate "now" advances in ticks per second (e.g. the core
+// timer's CPU_HZ/2), then call gfxGrayService() often (from the main
+// loop, or a timer interrupt) with the current tick count; it refreshes
+// when one is due, returning gfxGrayRefresh()'s page count, or 0.
+// A rate of 0 stops the refreshes.
+void gfxGraySetRate(uint16_t refreshHz, uint32_t ticksPerSec);
+uint8_t gfxGrayService(uint32_t now);
+
+#endif
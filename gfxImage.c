@@ -0,0 +1,87 @@
+//
+// gfxImage.c - Decoder for compressed page-format images
+//
+
+#include <stdint.h>
+#include <string.h>
+
+#include "gfx.h"
+#include "gfxImage.h"
+#include "st7565.h"
+
+//
+// Private variables
+//
+static uint8_t row[GFX_IMAGE_MAX_W];   // Page being decoded
+
+
+int16_t gfxImageWidth(const uint8_t *img)
+{
+    return img[0];
+}
+
+int16_t gfxImagePages(const uint8_t *img)
+{
+    return img[1];
+}
+
+// Decode the next page of an image into row[], in place over the previous
+// page (which the "same as above" runs copy from). Returns a pointer to
+// the following page's data.
+static const uint8_t *decodePage(const uint8_t *src, int16_t w)
+{
+    int16_t i = 0, n;
+    uint8_t c;
+
+    while(i < w)
+    {
+        c = *src++;
+        if(c & 0x80) {                 // Same as above: already in row[]
+            n = (c & 0x7f) + 1;
+            if(n > w - i) n = w - i;
+        }
+        else if(c & 0x40) {            // Repeat
+            n = (c & 0x3f) + 2;
+            if(n > w - i) n = w - i;
+            memset(&row[i], *src++, n);
+        }
+        else {                         // Literal
+            n = c + 1;
+            if(n > w - i) n = w - i;
+            memcpy(&row[i], src, n);
+            src += n;
+        }
+        i += n;
+    }
+    return src;
+}
+
+void gfxImageDraw(int16_t x, int16_t line, const uint8_t *img)
+{
+    int16_t w = img[0], pages = img[1], p;
+    const uint8_t *src = img + 2;
+
+    if(w > GFX_IMAGE_MAX_W) return;
+
+    memset(row, 0, w);
+    for(p = 0; p < pages; p++)
+    {
+        src = decodePage(src, w);
+        gfxBitmap(x, line + p, w, 1, row);
+    }
+}
+
+void gfxImageToLcd(uint8_t col, uint8_t page, const uint8_t *img)
+{
+    int16_t w = img[0], pages = img[1], p;
+    const uint8_t *src = img + 2;
+
+    if(w > GFX_IMAGE_MAX_W) return;
+
+    memset(row, 0, w);
+    for(p = 0; p < pages; p++)
+    {
+        src = decodePage(src, w);
+        lcdWriteSpan(page + p, col, row, w);
+    }
+}
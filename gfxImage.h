@@ -0,0 +1,40 @@
+#ifndef __GFXIMAGE_H_
+#define __GFXIMAGE_H_
+
+#include <stdint.h>
+
+//
+// Compressed page-format images
+//
+// Images are stored in the bitmap's page format (pages of 8 pixel rows,
+// one byte per column, MSB on top), compressed a page at a time. Made
+// from .pbm or .bmp files by tools/pbm2img.
+//
+// Format:
+//   byte 0:  width (pixels, 1..GFX_IMAGE_MAX_W)
+//   byte 1:  height (pages)
+//   then, for each page in turn, runs of:
+//     0x00..0x3F  n = c+1:        n literal bytes follow
+//     0x40..0x7F  n = (c&0x3F)+2: the next byte, repeated n times
+//     0x80..0xFF  n = (c&0x7F)+1: n bytes the same as the page above
+//                                 (zeros, for the first page)
+//   Runs don't cross the end of a page.
+//
+// Decoding needs one page-wide scratch row (GFX_IMAGE_MAX_W bytes of
+// static RAM), and no whole-image buffer.
+//
+
+#define GFX_IMAGE_MAX_W 132
+
+// Image size
+int16_t gfxImageWidth(const uint8_t *img);
+int16_t gfxImagePages(const uint8_t *img);
+
+// Decode an image into the gfx bitmap, at x (pixels), line (8-pixel lines)
+void gfxImageDraw(int16_t x, int16_t line, const uint8_t *img);
+
+// Decode an image straight to the LCD, one page burst at a time, at
+// column col, page "page" (pages numbered as for lcdWriteBuffer).
+void gfxImageToLcd(uint8_t col, uint8_t page, const uint8_t *img);
+
+#endif
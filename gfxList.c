@@ -0,0 +1,282 @@
+//
+// gfxList.c - Display list recording, and page-band rendering
+//
+
+#include <stdint.h>
+#include <string.h>
+
+#include "gfx.h"
+#include "gfxList.h"
+#include "st7565.h"
+
+// Command opcodes. Each command is one opcode byte, followed by its
+// arguments as 16-bit little-endian values (color is folded into the
+// opcode, in bit 7).
+enum {
+    opPIXEL = 1,  // x, y
+    opLINE,       // x0, y0, x1, y1
+    opRECT,       // x0, y0, x1, y1
+    opFRECT,      // x0, y0, x1, y1
+    opCIRCLE,     // x0, y0, r
+    opFCIRCLE,    // x0, y0, r
+    opSTRING,     // x, line, then the chars incl. the null-terminator
+    opBITMAP,     // x, line, w, pages, then the image pointer
+};
+#define opCOLOR 0x80
+
+#define MAX_PAGES 8     // Display pages, at most (bits of pageSent)
+#define RESEND_EVERY 8  // Renders between unconditional page re-sends
+
+//
+// Private variables
+//
+static uint8_t *list;                // The command buffer
+static int16_t listSize;             // Its size (bytes)
+static int16_t listLen;              // Bytes recorded
+static uint8_t listOverflow;         // A command didn't fit
+static int16_t width, height;        // Display size (pixels)
+static int16_t pages;                // Display height (pages)
+static uint8_t *band;                // One page band, "width" bytes
+static uint16_t pageSum[MAX_PAGES];  // CRC of each page, as last sent
+static uint8_t pageSent;             // Bit per page: pageSum[] is valid
+static uint8_t renders;              // Renders since the last re-send
+static int16_t resendPage;           // Page re-sent next
+
+
+void gfxListInit(uint8_t *listBuffer, int16_t size,
+                 int16_t bitmapWidth, int16_t bitmapHeight,
+                 uint8_t *_band)
+{
+    list = listBuffer;
+    listSize = size;
+    width = bitmapWidth;
+    height = bitmapHeight;
+    pages = bitmapHeight / 8;
+    if(pages > MAX_PAGES) pages = MAX_PAGES;    // (pageSum[], pageSent)
+    band = _band;
+    renders = 0;
+    resendPage = 0;
+
+    gfxListClear();
+    gfxListInvalidate();
+}
+
+void gfxListClear(void)
+{
+    listLen = 0;
+    listOverflow = 0;
+}
+
+uint8_t gfxListOverflow(void)
+{
+    return listOverflow;
+}
+
+int16_t gfxListUsed(void)
+{
+    return listLen;
+}
+
+void gfxListInvalidate(void)
+{
+    pageSent = 0;
+}
+
+// Reserve n bytes of list for a command, starting with its opcode. Returns
+// NULL if it won't fit.
+static uint8_t *cmdStart(uint8_t op, uint8_t color, int16_t n)
+{
+    uint8_t *p;
+
+    if(listLen + n > listSize) {
+        listOverflow = 1;
+        return NULL;
+    }
+    p = &list[listLen];
+    listLen += n;
+    *p++ = color ? (op | opCOLOR) : op;
+    return p;
+}
+
+static uint8_t *put16(uint8_t *p, int16_t v)
+{
+    *p++ = (uint8_t)v;
+    *p++ = (uint8_t)(v >> 8);
+    return p;
+}
+
+static int16_t get16(const uint8_t **p)
+{
+    int16_t v = (int16_t)((*p)[0] | ((*p)[1] << 8));
+    *p += 2;
+    return v;
+}
+
+// Record a command having a number of 16-bit arguments
+static void cmd4(uint8_t op, uint8_t color, int16_t nArgs,
+                 int16_t a, int16_t b, int16_t c, int16_t d)
+{
+    uint8_t *p = cmdStart(op, color, 1 + 2 * nArgs);
+
+    if(!p) return;
+    p = put16(p, a);
+    p = put16(p, b);
+    if(nArgs > 2) p = put16(p, c);
+    if(nArgs > 3) p = put16(p, d);
+}
+
+void gfxListPixel(int16_t x, int16_t y, uint8_t color)
+{
+    cmd4(opPIXEL, color, 2, x, y, 0, 0);
+}
+
+void gfxListLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color)
+{
+    cmd4(opLINE, color, 4, x0, y0, x1, y1);
+}
+
+void gfxListRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color)
+{
+    cmd4(opRECT, color, 4, x0, y0, x1, y1);
+}
+
+void gfxListFRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color)
+{
+    cmd4(opFRECT, color, 4, x0, y0, x1, y1);
+}
+
+void gfxListCircle(int16_t x0, int16_t y0, int16_t r, uint8_t color)
+{
+    cmd4(opCIRCLE, color, 3, x0, y0, r, 0);
+}
+
+void gfxListFCircle(int16_t x0, int16_t y0, int16_t r, uint8_t color)
+{
+    cmd4(opFCIRCLE, color, 3, x0, y0, r, 0);
+}
+
+void gfxListString(int16_t x, int16_t line, const char *c)
+{
+    int16_t n = strlen(c) + 1;
+    uint8_t *p = cmdStart(opSTRING, 1, 5 + n);
+
+    if(!p) return;
+    p = put16(p, x);
+    p = put16(p, line);
+    memcpy(p, c, n);
+}
+
+void gfxListBitmap(int16_t x, int16_t line, int16_t w, int16_t pages,
+                   const uint8_t *img)
+{
+    uint8_t *p = cmdStart(opBITMAP, 1, 9 + sizeof(img));
+
+    if(!p) return;
+    p = put16(p, x);
+    p = put16(p, line);
+    p = put16(p, w);
+    p = put16(p, pages);
+    memcpy(p, &img, sizeof(img));
+}
+
+// Replay the whole list into the current band
+static void replay(void)
+{
+    const uint8_t *p = list;
+    const uint8_t *end = list + listLen;
+    const uint8_t *img;
+    int16_t a, b, c, d;
+    uint8_t op, color;
+
+    while(p < end)
+    {
+        op = *p & ~opCOLOR;
+        color = (*p++ & opCOLOR) ? 1 : 0;
+        a = get16(&p);
+        b = get16(&p);
+
+        switch(op)
+        {
+        case opPIXEL:   gfxPixel(a, b, color); break;
+        case opLINE:    c = get16(&p); d = get16(&p); gfxLine(a, b, c, d, color);  break;
+        case opRECT:    c = get16(&p); d = get16(&p); gfxRect(a, b, c, d, color);  break;
+        case opFRECT:   c = get16(&p); d = get16(&p); gfxFRect(a, b, c, d, color); break;
+        case opCIRCLE:  c = get16(&p); gfxCircle(a, b, c, color);  break;
+        case opFCIRCLE: c = get16(&p); gfxFCircle(a, b, c, color); break;
+        case opSTRING:
+            gfxString(a, b, (char *)p);
+            p += strlen((const char *)p) + 1;
+            break;
+        case opBITMAP:
+            c = get16(&p);
+            d = get16(&p);
+            memcpy(&img, p, sizeof(img));
+            p += sizeof(img);
+            gfxBitmap(a, b, c, d, img);
+            break;
+        default:
+            return;   // Corrupt list; stop here
+        }
+    }
+}
+
+// CRC-16 (CCITT polynomial, 0x1021) of a band, for spotting pages that
+// haven't changed, a nybble at a time. Unlike an additive checksum, it
+// has no bytes that count the same (0x00 and 0xff), and it catches every
+// change to up to 16 adjacent bits, or to an odd number of bits. Other
+// changes can still collide (about 1 in 65536); a page that does is put
+// right by the re-sends in gfxListRender.
+static const uint16_t crcNybble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+static uint16_t bandSum(void)
+{
+    uint16_t crc = 0xffff;
+    int16_t i;
+
+    for(i = 0; i < width; i++) {
+        crc = (crc << 4) ^ crcNybble[(crc >> 12) ^ (band[i] >> 4)];
+        crc = (crc << 4) ^ crcNybble[(crc >> 12) ^ (band[i] & 0x0f)];
+    }
+    return crc;
+}
+
+uint8_t gfxListRender(void)
+{
+    int16_t page, resend, w, h, first, n;
+    uint8_t *buff;
+    uint16_t sum;
+    uint8_t sent = 0;
+
+    // Every RESEND_EVERY renders, one page goes whether it changed or not,
+    // in turn: the LCD can't stay wrong after a CRC collision.
+    resend = -1;
+    if(++renders >= RESEND_EVERY) {
+        renders = 0;
+        resend = resendPage;
+        if(++resendPage >= pages) resendPage = 0;
+    }
+
+    gfxGetBand(&w, &h, &buff, &first, &n);  // To be put back afterwards
+
+    for(page = 0; page < pages; page++)
+    {
+        gfxInitBand(width, height, band, page, 1);
+        gfxFill(0);
+        replay();
+
+        sum = bandSum();
+        if((pageSent & (1 << page)) && pageSum[page] == sum && page != resend)
+            continue;   // Same as what the LCD has already
+
+        lcdWriteSpan(page, 0, band, width);
+        pageSum[page] = sum;
+        pageSent |= 1 << page;
+        sent++;
+    }
+
+    gfxInitBand(w, h, buff, first, n);
+    return sent;
+}
@@ -0,0 +1,60 @@
+#ifndef __GFXLIST_H_
+#define __GFXLIST_H_
+
+#include <stdint.h>
+
+//
+// Display lists
+//
+// Instead of drawing into a full width*height/8 bitmap, gfx calls are
+// recorded into a compact command buffer. The list is then replayed once
+// per LCD page into a single page-sized band buffer, and each band is sent
+// to the LCD as soon as it's rendered. RAM needed is the list itself plus
+// one 128-byte band, rather than the 1 KB bitmap.
+//
+// Pages whose rendered contents are unchanged since the previous
+// gfxListRender() are not re-sent, going by a CRC of each page. So that a
+// CRC collision can't leave a page wrong for good, one page in turn is
+// sent regardless every 8 renders.
+//
+
+// gfxListInit - Supply the command buffer, the display size, and a band
+//               buffer of bitmapWidth bytes. Rendering takes over the gfx
+//               routines' bitmap (see gfxInitBand). Pages are sent as
+//               they are in landscape (with lcdWriteSpan), and only the
+//               first 8 are rendered: use 128x64, not portrait.
+//
+void gfxListInit(uint8_t *listBuffer, int16_t listSize,
+                 int16_t bitmapWidth, int16_t bitmapHeight,
+                 uint8_t *band);
+
+// Empty the list, ready to record the next frame
+void gfxListClear(void);
+
+// Non-zero if a command didn't fit in the list buffer since the last clear
+uint8_t gfxListOverflow(void);
+
+// Bytes of the list buffer in use
+int16_t gfxListUsed(void);
+
+// Forget what was last sent, so the next render sends every page
+void gfxListInvalidate(void);
+
+// Recording versions of the gfx.h routines (same arguments)
+void gfxListPixel(int16_t x, int16_t y, uint8_t color);
+void gfxListLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color);
+void gfxListRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color);
+void gfxListFRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color);
+void gfxListCircle(int16_t x0, int16_t y0, int16_t r, uint8_t color);
+void gfxListFCircle(int16_t x0, int16_t y0, int16_t r, uint8_t color);
+void gfxListString(int16_t x, int16_t line, const char *c);  // Copied into the list
+void gfxListBitmap(int16_t x, int16_t line,                  // Image is referenced,
+                   int16_t w, int16_t pages,                 // not copied
+                   const uint8_t *img);
+
+// Replay the list into the band, one page at a time, sending each changed
+// page to the LCD. gfx is left drawing in the bitmap (or band) it had
+// before. Returns the number of pages sent.
+uint8_t gfxListRender(void);
+
+#endif
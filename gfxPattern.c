@@ -0,0 +1,57 @@
+//
+// Standard 8x8 fill patterns (see gfxPattern.h)
+//
+// Gray levels are taken from an 8x8 Bayer matrix, so each level includes
+// the pixels of the lighter ones. Hatches repeat every 4 pixels.
+//
+#include <stdint.h>
+
+#include "gfxPattern.h"
+
+const uint8_t gfxPatGray12[8] = {
+    0x88, 0x00, 0x22, 0x00, 0x88, 0x00, 0x22, 0x00
+};   // 1/8 on (Bayer)
+
+const uint8_t gfxPatGray25[8] = {
+    0xAA, 0x00, 0xAA, 0x00, 0xAA, 0x00, 0xAA, 0x00
+};   // 1/4 on (Bayer)
+
+const uint8_t gfxPatGray50[8] = {
+    0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55
+};   // 1/2 on: checkerboard
+
+const uint8_t gfxPatGray75[8] = {
+    0xAA, 0xFF, 0xAA, 0xFF, 0xAA, 0xFF, 0xAA, 0xFF
+};   // 3/4 on (Bayer)
+
+const uint8_t gfxPatGray88[8] = {
+    0xEE, 0xFF, 0xBB, 0xFF, 0xEE, 0xFF, 0xBB, 0xFF
+};   // 7/8 on (Bayer)
+
+const uint8_t gfxPatHatchH[8] = {
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88
+};   // Horizontal lines, 4 apart
+
+const uint8_t gfxPatHatchV[8] = {
+    0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00
+};   // Vertical lines, 4 apart
+
+const uint8_t gfxPatHatchDown[8] = {
+    0x88, 0x44, 0x22, 0x11, 0x88, 0x44, 0x22, 0x11
+};   // Diagonal lines, top-left to bottom-right
+
+const uint8_t gfxPatHatchUp[8] = {
+    0x11, 0x22, 0x44, 0x88, 0x11, 0x22, 0x44, 0x88
+};   // Diagonal lines, bottom-left to top-right
+
+const uint8_t gfxPatCross[8] = {
+    0xFF, 0x88, 0x88, 0x88, 0xFF, 0x88, 0x88, 0x88
+};   // Horizontal and vertical lines (grid)
+
+const uint8_t gfxPatDiagCross[8] = {
+    0x99, 0x66, 0x66, 0x99, 0x99, 0x66, 0x66, 0x99
+};   // Both diagonals
+
+const uint8_t gfxPatDots[8] = {
+    0x88, 0x00, 0x00, 0x00, 0x88, 0x00, 0x00, 0x00
+};   // A dot every 4 pixels
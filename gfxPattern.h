@@ -0,0 +1,26 @@
+#ifndef __GFXPATTERN_H_
+#define __GFXPATTERN_H_
+
+#include <stdint.h>
+
+//
+// 8x8 fill patterns, for gfxPatFRect, gfxPatFCircle and gfxPatFillPoly
+//
+// A tile is 8 bytes, one per column, most significant bit on top: the
+// same layout as a page of the bitmap, so a tile lines up with 8 columns
+// of a page and is applied a byte at a time.
+//
+extern const uint8_t gfxPatGray12[8];
+extern const uint8_t gfxPatGray25[8];
+extern const uint8_t gfxPatGray50[8];
+extern const uint8_t gfxPatGray75[8];
+extern const uint8_t gfxPatGray88[8];
+extern const uint8_t gfxPatHatchH[8];
+extern const uint8_t gfxPatHatchV[8];
+extern const uint8_t gfxPatHatchDown[8];
+extern const uint8_t gfxPatHatchUp[8];
+extern const uint8_t gfxPatCross[8];
+extern const uint8_t gfxPatDiagCross[8];
+extern const uint8_t gfxPatDots[8];
+
+#endif
@@ -0,0 +1,249 @@
+//
+// gfxSprite.c - Sprite / cursor overlays with save-under or XOR drawing
+//
+
+#include <stdint.h>
+#include <string.h>
+
+#include "gfxDamage.h"
+#include "gfxSprite.h"
+
+#define SAVE_BYTES (GFX_SPRITE_PAGES * GFX_SPRITE_MAX_W)
+
+typedef struct {
+    const uint8_t *image;
+    const uint8_t *mask;
+    int16_t x, y;             // Top-left (pixels)
+    uint8_t w, h;             // Size (pixels)
+    uint8_t mode;             // GFX_SPRITE_SAVE or GFX_SPRITE_XOR
+    uint8_t shown;            // Drawn on the bitmap
+    uint8_t hiddenByAll;      // Hidden by gfxSpriteHideAll
+    uint8_t save[SAVE_BYTES]; // Bitmap bytes under the sprite
+} sprite_t;
+
+//
+// Private variables
+//
+static sprite_t sprites[GFX_SPRITE_MAX];
+static int8_t   nSprites;
+static uint8_t  *bmap;
+static int16_t  bmapWidth, bmapPages;
+
+
+void gfxSpriteInit(uint8_t *bitmap, int16_t width, int16_t height)
+{
+    bmap = bitmap;
+    bmapWidth = width;
+    bmapPages = height / 8;
+    nSprites = 0;
+}
+
+int8_t gfxSpriteAdd(const uint8_t *image, const uint8_t *mask,
+                    uint8_t w, uint8_t h, uint8_t mode)
+{
+    sprite_t *sp;
+
+    if(nSprites >= GFX_SPRITE_MAX) return -1;
+    if(w > GFX_SPRITE_MAX_W || h > GFX_SPRITE_MAX_H) return -1;
+
+    sp = &sprites[nSprites];
+    memset(sp, 0, sizeof(*sp));
+    sp->image = image;
+    sp->mask = mask;
+    sp->w = w;
+    sp->h = h;
+    sp->mode = mode;
+    return nSprites++;
+}
+
+// Page holding row y (rounding down, for y < 0 too)
+static int16_t pageOf(int16_t y)
+{
+    return y >= 0 ? y / 8 : -((7 - y) / 8);
+}
+
+// Byte of a page-format image, for sprite page p (0..), shifted down by s
+// pixels to line up with the bitmap's pages
+static uint8_t shifted(const uint8_t *img, sprite_t *sp, int16_t p,
+                       uint8_t s)
+{
+    int16_t pages = (sp->h + 7) / 8;
+    uint8_t b = 0;
+
+    if(p < pages)
+        b = img[p * sp->w] >> s;
+    if(p > 0 && s)
+        b |= (uint8_t)(img[(p - 1) * sp->w] << (8 - s));
+    return b;
+}
+
+// Add a span to a list, merging it with one on the same page if they
+// overlap or touch. Returns the new count.
+static uint8_t addSpan(gfxSpan_t spans[], uint8_t n,
+                       int16_t page, int16_t col0, int16_t col1)
+{
+    uint8_t i;
+
+    gfxDamageSpan(page, col0, col1);
+    if(!spans) return n;
+
+    for(i = 0; i < n; i++)
+    {
+        if(spans[i].page == page &&
+           col0 <= spans[i].col1 + 1 && col1 >= spans[i].col0 - 1)
+        {
+            if(col0 < spans[i].col0) spans[i].col0 = col0;
+            if(col1 > spans[i].col1) spans[i].col1 = col1;
+            return n;
+        }
+    }
+    spans[n].page = page;
+    spans[n].col0 = col0;
+    spans[n].col1 = col1;
+    return n + 1;
+}
+
+// Draw (show != 0) or remove a sprite at its position. Appends the changed
+// spans; returns the new count.
+static uint8_t paint(sprite_t *sp, uint8_t show, gfxSpan_t spans[], uint8_t n)
+{
+    uint8_t s = sp->y & 7;
+    int16_t p, pages = (s + sp->h + 7) / 8;
+    int16_t page0 = pageOf(sp->y);
+    int16_t c, col0, col1;
+    uint8_t *dst, *save, img, mask;
+
+    // Columns on the bitmap
+    col0 = sp->x < 0 ? 0 : sp->x;
+    col1 = sp->x + sp->w - 1;
+    if(col1 >= bmapWidth) col1 = bmapWidth - 1;
+    if(col0 > col1) return n;
+
+    for(p = 0; p < pages; p++)
+    {
+        if(page0 + p < 0 || page0 + p >= bmapPages) continue;
+
+        dst = &bmap[(page0 + p) * bmapWidth];
+        save = &sp->save[p * GFX_SPRITE_MAX_W];
+
+        for(c = col0; c <= col1; c++)
+        {
+            img = shifted(sp->image + c - sp->x, sp, p, s);
+
+            if(sp->mode == GFX_SPRITE_XOR)
+                dst[c] ^= img;
+            else if(show) {
+                mask = shifted(sp->mask + c - sp->x, sp, p, s);
+                save[c - sp->x] = dst[c] & mask;
+                dst[c] = (dst[c] & ~mask) | (img & mask);
+            }
+            else {
+                mask = shifted(sp->mask + c - sp->x, sp, p, s);
+                dst[c] = (dst[c] & ~mask) | save[c - sp->x];
+            }
+        }
+        n = addSpan(spans, n, page0 + p, col0, col1);
+    }
+    return n;
+}
+
+// Remove the shown sprites above "id", topmost first
+static void unstack(int8_t id)
+{
+    int8_t i;
+
+    for(i = nSprites - 1; i > id; i--)
+        if(sprites[i].shown)
+            paint(&sprites[i], 0, NULL, 0);
+}
+
+// Redraw the shown sprites above "id". (Their pixels are the same as before
+// unstack(), so no damage is recorded for them.)
+static void restack(int8_t id)
+{
+    int8_t i;
+
+    for(i = id + 1; i < nSprites; i++)
+        if(sprites[i].shown)
+            paint(&sprites[i], 1, NULL, 0);
+}
+
+// paint(), with the sprites above taken off first, and put back after
+static uint8_t paintInStack(int8_t id, uint8_t show, gfxSpan_t spans[],
+                            uint8_t n)
+{
+    unstack(id);
+    n = paint(&sprites[id], show, spans, n);
+    restack(id);
+    return n;
+}
+
+uint8_t gfxSpriteShow(int8_t id, gfxSpan_t spans[])
+{
+    if(id < 0 || id >= nSprites || sprites[id].shown) return 0;
+    sprites[id].shown = 1;
+    return paintInStack(id, 1, spans, 0);
+}
+
+uint8_t gfxSpriteHide(int8_t id, gfxSpan_t spans[])
+{
+    uint8_t n;
+
+    if(id < 0 || id >= nSprites || !sprites[id].shown) return 0;
+    n = paintInStack(id, 0, spans, 0);
+    sprites[id].shown = 0;
+    return n;
+}
+
+uint8_t gfxSpriteMove(int8_t id, int16_t x, int16_t y, gfxSpan_t spans[])
+{
+    sprite_t *sp;
+    uint8_t n = 0;
+
+    if(id < 0 || id >= nSprites) return 0;
+    sp = &sprites[id];
+
+    if(!sp->shown) {
+        sp->x = x;
+        sp->y = y;
+        return 0;
+    }
+
+    // Shown sprites above could overlap either position; keep them
+    // off for both paints
+    unstack(id);
+    n = paint(sp, 0, spans, n);
+    sp->x = x;
+    sp->y = y;
+    n = paint(sp, 1, spans, n);
+    restack(id);
+    return n;
+}
+
+void gfxSpriteHideAll(void)
+{
+    int8_t i;
+
+    for(i = nSprites - 1; i >= 0; i--)
+    {
+        sprites[i].hiddenByAll = sprites[i].shown;
+        if(sprites[i].shown) {
+            paint(&sprites[i], 0, NULL, 0);
+            sprites[i].shown = 0;
+        }
+    }
+}
+
+void gfxSpriteShowAll(void)
+{
+    int8_t i;
+
+    for(i = 0; i < nSprites; i++)
+    {
+        if(sprites[i].hiddenByAll) {
+            sprites[i].shown = 1;
+            sprites[i].hiddenByAll = 0;
+            paint(&sprites[i], 1, NULL, 0);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef __GFXSPRITE_H_
+#define __GFXSPRITE_H_
+
+#include <stdint.h>
+
+#include "gfxDamage.h"
+
+//
+// Sprites and cursors
+//
+// A small, fixed number of images drawn over the bitmap, which can be
+// moved without redrawing what's underneath. Images and masks are in the
+// bitmap's page format (w bytes per 8-pixel page, MSB on top); mask bits
+// beyond the sprite's height must be zero.
+//
+//   GFX_SPRITE_SAVE: Pixels under the mask are saved before drawing, and
+//                    put back on hiding/moving.
+//   GFX_SPRITE_XOR:  The image is XORed onto the bitmap (the mask is not
+//                    used), and XORed again to remove it. Needs no saved
+//                    pixels, but may be hard to see on busy backgrounds.
+//
+// Sprites are stacked in the order they were added. Hide them all (see
+// gfxSpriteHideAll) before drawing on the bitmap underneath them.
+//
+// Each call that changes the bitmap marks the changed bytes in gfxDamage,
+// and, if "spans" isn't NULL, also returns them there, merged per page
+// (up to GFX_SPRITE_MAX_SPANS spans).
+//
+
+#define GFX_SPRITE_MAX      4   // Number of sprites
+#define GFX_SPRITE_MAX_W   16   // Max width (pixels)
+#define GFX_SPRITE_MAX_H   16   // Max height (pixels)
+
+#define GFX_SPRITE_SAVE  0
+#define GFX_SPRITE_XOR   1
+
+// Pages a sprite can overlap (one more than it holds, when not aligned),
+// and the most spans one call can report: old and new position.
+#define GFX_SPRITE_PAGES     ((GFX_SPRITE_MAX_H + 7) / 8 + 1)
+#define GFX_SPRITE_MAX_SPANS (2 * GFX_SPRITE_PAGES)
+
+// Remove all sprites; "bitmap" is the buffer given to gfxInit
+void gfxSpriteInit(uint8_t *bitmap, int16_t width, int16_t height);
+
+// Add a (hidden) sprite. Returns its id, or -1 if there's no room or it's
+// too large.
+int8_t gfxSpriteAdd(const uint8_t *image, const uint8_t *mask,
+                    uint8_t w, uint8_t h, uint8_t mode);
+
+// Show, hide, or move (shown or not) a sprite. Return the number of spans
+// changed.
+uint8_t gfxSpriteShow(int8_t id, gfxSpan_t spans[]);
+uint8_t gfxSpriteHide(int8_t id, gfxSpan_t spans[]);
+uint8_t gfxSpriteMove(int8_t id, int16_t x, int16_t y, gfxSpan_t spans[]);
+
+// Hide / re-show every shown sprite, around drawing on the bitmap. These
+// leave the bitmap as it was, so record no damage.
+void gfxSpriteHideAll(void);
+void gfxSpriteShowAll(void);
+
+#endif
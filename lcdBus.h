@@ -0,0 +1,167 @@
+#ifndef __LCDBUS_H_
+#define __LCDBUS_H_
+
+#include <stdint.h>
+
+#include "st7565.h"
+
+//
+// ST7565 transport
+//
+// What st7565.c needs of the bus to the controller, resolved at compile
+// time: static inline, so the command code compiles down to the same port
+// and SPI register accesses as if it were written against them directly.
+//
+//   lcdBusPin(pin, level)   - Set a control line (/CS1, A0, /RES) lo or hi
+//   lcdBusDir(input)        - Data lines to input (for reads), or back
+//   lcdBusWrite(p, data, n) - Clock n bytes out to panel p, /CS1 low
+//   lcdBusRead(p)           - Clock a byte in
+//   lcdBusDelayUs(us)       - Busy-wait
+//   LCD_BUS_CAN_READ        - 1 if the controller can be read back
+//
+// The backend is chosen with the interface (see product_config.h):
+//
+//   LCD_PARALLEL - 8080-style parallel, bit-banged on the board's port
+//                  pins (LCD_DB, WRn_, RDn_)
+//   LCD_SERIAL   - SPI, through plib. Write only.
+//   LCD_MOCK     - No hardware: calls the lcdMock hooks below, which the
+//                  host program supplies, along with tickNow etc. (see
+//                  p32_utils.h). For building and benchmarking st7565.c
+//                  (and what draws through it) on a PC.
+//
+// Included by st7565.c, after the board's pin definitions.
+//
+
+#if defined LCD_MOCK
+
+#define LCD_BUS_CAN_READ 1
+
+// Control line bits, for the board definitions in st7565.c
+#define LCD_MOCK_CS  0x01
+#define LCD_MOCK_A0  0x02
+#define LCD_MOCK_RES 0x04
+
+void    lcdMockPin(const lcdPin_t *pin, uint8_t level);
+void    lcdMockDir(uint8_t input);
+void    lcdMockWrite(const lcdPanel_t *p, uint8_t data);
+uint8_t lcdMockRead(const lcdPanel_t *p);
+void    lcdMockDelayUs(uint32_t us);
+
+static inline void lcdBusPin(const lcdPin_t *pin, uint8_t level)
+{
+    lcdMockPin(pin, level);
+}
+
+static inline void lcdBusDir(uint8_t input)
+{
+    lcdMockDir(input);
+}
+
+static inline void lcdBusDelayUs(uint32_t us)
+{
+    lcdMockDelayUs(us);
+}
+
+static inline void lcdBusWrite(const lcdPanel_t *p, const uint8_t data[], int n)
+{
+    int i;
+
+    for(i=0; i<n; i++)
+        lcdMockWrite(p, data[i]);
+}
+
+static inline uint8_t lcdBusRead(const lcdPanel_t *p)
+{
+    return lcdMockRead(p);
+}
+
+#else   // Port registers: PIC32
+
+static inline void lcdBusPin(const lcdPin_t *pin, uint8_t level)
+{
+    if(level) *pin->set = pin->bit;
+    else      *pin->clr = pin->bit;
+}
+
+static inline void lcdBusDelayUs(uint32_t us)
+{
+    delay_us(us);
+}
+
+#if defined LCD_SERIAL
+
+#define LCD_BUS_CAN_READ 0
+
+static inline void lcdBusDir(uint8_t input)
+{
+}
+
+static inline void lcdBusWrite(const lcdPanel_t *p, const uint8_t data[], int n)
+{
+    int i;
+
+    for(i=0; i<n; i++)
+    {
+        SpiChnPutC(p->spiChannel, data[i]);
+        // TODO:  YUCK!! We have to wait for the SPI byte to have
+        //        been sent, before we continue (with raising CS1n).
+        //        Find a way to wait for Tx complete, or rework.
+        //delay_us(250);
+        while(SpiChnIsBusy(p->spiChannel));   // Seems to work, but still have to wait some...
+    }
+    delay_us(15);                  // This fails at 5us; passes at 10 (M4492)
+}
+
+static inline uint8_t lcdBusRead(const lcdPanel_t *p)
+{
+    return 0;
+}
+
+#elif defined LCD_PARALLEL
+
+#define LCD_BUS_CAN_READ 1
+
+static inline void lcdBusDir(uint8_t input)
+{
+    if(input) TRISESET = 0x00ff;    // TODO: move this (to the board defs)
+    else      TRISECLR = 0x00ff;
+}
+
+static inline void lcdBusWrite(const lcdPanel_t *p, const uint8_t data[], int n)
+{
+    uint16_t tmp16;
+    int i;
+
+    for(i=0; i<n; i++)
+    {
+        tmp16 = LCD_DB & 0xff00;
+        tmp16 |= data[i];
+        LCD_DB = tmp16;
+        delay_us(5);
+        WRn_LO();
+        delay_us(5);
+        WRn_HI();
+        delay_us(5);
+    }
+}
+
+static inline uint8_t lcdBusRead(const lcdPanel_t *p)
+{
+    uint16_t tmp16;
+
+    RDn_LO();
+    delay_us(5);
+    tmp16 = LCD_DB;
+    RDn_HI();
+    delay_us(5);
+
+    return (uint8_t)tmp16;
+}
+
+#else
+    #error Need to define LCD_SERIAL, LCD_PARALLEL or LCD_MOCK
+#endif
+
+#endif
+
+#endif
@@ -36,7 +36,7 @@ void delay_ms(uint32_t msec)
 #define TICK_HZ (CPU_HZ/2)
 void delay_us(uint32_t usec)
 {
-    uint32_t  t, stop;
+    uint32_t  stop;
 
     // Calculate number of ticks for the given number of microseconds
     stop = usec * (TICK_HZ / 1000000);  // 40 ticks/us for 80MHz
@@ -44,11 +44,30 @@ void delay_us(uint32_t usec)
     // Get current tick-time, and add to our tick-interval
     stop += _mfc0(_CP0_COUNT, _CP0_COUNT_SELECT);
 
-    // Wait till Count reaches the stop valu
-    while (1)
-	{
-        t = _mfc0(_CP0_COUNT, _CP0_COUNT_SELECT);
-		if(t >= stop) break;
-	}
+    // Wait till Count reaches the stop value. (Compared as a signed
+    // difference: "t >= stop" fails when Count wraps in between.)
+    while ((int32_t)(_mfc0(_CP0_COUNT, _CP0_COUNT_SELECT) - stop) < 0)
+        ;
+}
+
+
+/******************************************************************************
+*	tickNow(), tickFromUs(), tickFromMs()
+*
+*	Tick count (CP0 Count) and conversions to ticks. See p32_utils.h.
+******************************************************************************/
+uint32_t tickNow(void)
+{
+    return _mfc0(_CP0_COUNT, _CP0_COUNT_SELECT);
+}
+
+uint32_t tickFromUs(uint32_t usec)
+{
+    return usec * (TICK_HZ / 1000000);
+}
+
+uint32_t tickFromMs(uint32_t msec)
+{
+    return msec * (TICK_HZ / 1000);
 } 
 
@@ -7,4 +7,16 @@ void delay_ms(uint32_t msec);
 void delay_us(uint32_t usec);
 
 
+// Monotonic tick count: the CP0 core timer, which runs at CPU_HZ/2 (40
+// ticks per us at 80 MHz) and wraps about every 107 s at that rate.
+// Compare tick counts only through tickExpired() / tickSince(), which
+// are right across the wrap for intervals up to half of it.
+uint32_t tickNow(void);
+uint32_t tickFromUs(uint32_t usec);
+uint32_t tickFromMs(uint32_t msec);
+
+#define tickSince(t)      (tickNow() - (t))
+#define tickExpired(due)  ((int32_t)(tickNow() - (due)) >= 0)
+
+
 
@@ -2,34 +2,40 @@
 // ST7565 - Sitronix ST7565x 65x132 Dot Matrix LCD  Controller/Driver
 //
 
-// TODOs
-//
 // Datasheet recommends 'operating modes be refreshed periodically', in case the
-// part has lost it's mind??
+// part has lost it's mind (e.g. after ESD): see lcdRefreshTask().
 
 
-#include <plib.h>
+#include <stddef.h>
 
 #include "product_config.h"
+#if !defined LCD_MOCK
+#include <plib.h>
+#endif
+
 #include "p32_utils.h"
 #include "st7565.h"
 
-// Hardware line definitions (TODO: Where does it make best sense
-//    to place these defs - in a "hal.h" ?)
+// Hardware line definitions. How they're driven is up to the transport,
+// lcdBus.h.
 //
 
 
-#if defined ST7565_NHD_PROTOTYPE_STARTERKIT || defined ST7565_M4557_PROTOTYPE_STARTERKIT
+#if defined LCD_MOCK
+
+  // No hardware (host build): the lines are just told to the mock
+  #define CS1n_PIN  { 0, 0, LCD_MOCK_CS }
+  #define RESn_PIN  { 0, 0, LCD_MOCK_RES }
+  #define A0_PIN    { 0, 0, LCD_MOCK_A0 }
+
+#elif defined ST7565_NHD_PROTOTYPE_STARTERKIT || defined ST7565_M4557_PROTOTYPE_STARTERKIT
 
   // Port assignemnt for using a parallel ST7565 interface on the PIC32 Starter Kit
   //
   //               Starter-Kit 2,    J10-
-  #define CS1n_LO()  LATBCLR=BIT_10   // 47
-  #define CS1n_HI()  LATBSET=BIT_10
-  #define RESn_LO()  LATBCLR=BIT_11   // 48
-  #define RESn_HI()  LATBSET=BIT_11
-  #define A0_LO()    LATBCLR=BIT_12   // 49
-  #define A0_HI()    LATBSET=BIT_12
+  #define CS1n_PIN  { &LATBCLR, &LATBSET, BIT_10 }   // 47
+  #define RESn_PIN  { &LATBCLR, &LATBSET, BIT_11 }   // 48
+  #define A0_PIN    { &LATBCLR, &LATBSET, BIT_12 }   // 49
   #define WRn_LO()   LATBCLR=BIT_13   // 50
   #define WRn_HI()   LATBSET=BIT_13
   #define RDn_LO()   LATBCLR=BIT_14   // 59
@@ -42,12 +48,9 @@
   // Port assignemnt for using parallel ST7565 interface on Olimex Duinomite
   //
   //                 Duinomite,    GPIO-
-  #define CS1n_LO()  LATBCLR=BIT_3    // 21
-  #define CS1n_HI()  LATBSET=BIT_3
-  #define RESn_LO()  LATBCLR=BIT_4    // 19
-  #define RESn_HI()  LATBSET=BIT_4
-  #define A0_LO()    LATBCLR=BIT_6    // 17
-  #define A0_HI()    LATBSET=BIT_6
+  #define CS1n_PIN  { &LATBCLR, &LATBSET, BIT_3 }    // 21
+  #define RESn_PIN  { &LATBCLR, &LATBSET, BIT_4 }    // 19
+  #define A0_PIN    { &LATBCLR, &LATBSET, BIT_6 }    // 17
   #define WRn_LO()   LATBCLR=BIT_7    // 15
   #define WRn_HI()   LATBSET=BIT_7
   #define RDn_LO()   LATBCLR=BIT_9    // 13
@@ -62,15 +65,11 @@
   // Olimex UEXT connector.  In addition to the SPI lines, MISO1,
   // MOSI1, and SCK1 on pins 7,8,9, we use:
   //
-  #define A0_LO()   LATFCLR=BIT_8  /* UEXT-3 (RF8/TXD1) */
-  #define A0_HI()   LATFSET=BIT_8
-  #define RESn_LO() LATFCLR=BIT_2  /* UEXT-4 (RF2/RXD1)*/
-  #define RESn_HI() LATFSET=BIT_2
-  #define CS1n_LO() LATDCLR=BIT_9  /* UEXT-10 (RD9/CS_UEXT) */
-  #define CS1n_HI() LATDSET=BIT_9
+  #define A0_PIN   { &LATFCLR, &LATFSET, BIT_8 }  /* UEXT-3 (RF8/TXD1) */
+  #define RESn_PIN { &LATFCLR, &LATFSET, BIT_2 }  /* UEXT-4 (RF2/RXD1)*/
+  #define CS1n_PIN { &LATDCLR, &LATDSET, BIT_9 }  /* UEXT-10 (RD9/CS_UEXT) */
 
   #define LCD_SPI_CH  SPI_CHANNEL1
-  #define LCD_SPIBUSY SPI1STATbits.SPIBUSY
 
 #elif defined ST7565_M4492_OLIMEX_PINGUINO_OTG
 
@@ -79,20 +78,78 @@
   // Olimex UEXT connector.  In addition to the SPI lines, MISO1,
   // MOSI1, and SCK1 on pins 7,8,9, we use:
   //
-  #define A0_LO()   LATFCLR=BIT_5  /* UEXT-3 (RF8/TXD1) */
-  #define A0_HI()   LATFSET=BIT_5
-  #define RESn_LO() LATFCLR=BIT_4  /* UEXT-4 (RF2/RXD1)*/
-  #define RESn_HI() LATFSET=BIT_4
-  #define CS1n_LO() LATFCLR=BIT_0  /* UEXT-10 (RD9/CS_UEXT) */
-  #define CS1n_HI() LATFSET=BIT_0
+  #define A0_PIN   { &LATFCLR, &LATFSET, BIT_5 }  /* UEXT-3 (RF8/TXD1) */
+  #define RESn_PIN { &LATFCLR, &LATFSET, BIT_4 }  /* UEXT-4 (RF2/RXD1)*/
+  #define CS1n_PIN { &LATFCLR, &LATFSET, BIT_0 }  /* UEXT-10 (RD9/CS_UEXT) */
 
   #define LCD_SPI_CH  SPI_CHANNEL2
-  #define LCD_SPIBUSY SPI2STATbits.SPIBUSY
 
 #else
   #error must define port setup macro
 #endif
 
+#if !defined LCD_SPI_CH
+  #define LCD_SPI_CH  0     // (Parallel interface)
+#endif
+
+#include "lcdBus.h"
+
+// The board's display, as wired above
+lcdPanel_t lcdPanel0 = {
+    .cs = CS1n_PIN, .a0 = A0_PIN, .res = RESn_PIN,
+    .spiChannel = LCD_SPI_CH, .width = 128, .pages = 8,
+    .orientation = LCD_ORIENT_0
+};
+
+//
+// Private variables
+//
+static lcdPanel_t *cur = &lcdPanel0;    // Panel selected by lcdSelect()
+
+// Control lines of the selected panel
+#define CS1n_LO()  lcdBusPin(&cur->cs, 0)
+#define CS1n_HI()  lcdBusPin(&cur->cs, 1)
+#define A0_LO()    lcdBusPin(&cur->a0, 0)
+#define A0_HI()    lcdBusPin(&cur->a0, 1)
+#define RESn_LO()  lcdBusPin(&cur->res, 0)
+#define RESn_HI()  lcdBusPin(&cur->res, 1)
+
+// The pause each transfer ends with, after raising /CS, isn't waited out
+// there and then: it is noted, and the panel's next transfer waits for
+// whatever is left of it. Time spent on another panel meanwhile (or on
+// anything else) counts towards it.
+#define PAD_US(us)  (cur->idleAt = tickNow(), cur->pad = tickFromUs(us))
+
+static void waitPad(void)
+{
+    while(tickSince(cur->idleAt) < cur->pad);
+}
+
+static void clearPage(uint8_t page);
+static void writePage(uint8_t page, const uint8_t *buff);
+
+// Send page "page" of lcdInitTask's first frame (zeros if frame is NULL)
+//
+static void initPage(uint8_t page, const uint8_t *frame)
+{
+    if(frame)
+        writePage(page, frame);
+    else
+        clearPage(page);
+}
+
+// One step of an lcdInitTask wait: a page of the first frame, if any are
+// left. True once the wait (t->due) is over.
+//
+static uint8_t initStep(task_t *t, const uint8_t *frame)
+{
+    if(t->i < cur->pages) initPage(t->i++, frame);
+    return tickExpired(t->due);
+}
+
+#define INIT_WAIT_MS(t, ms, frame)                     \
+    do { (t)->due = tickNow() + tickFromMs(ms);         \
+         TASK_WAIT_UNTIL(t, initStep(t, frame)); } while(0)
 
 // lcdInit()
 //
@@ -103,19 +160,43 @@ void lcdInit(
     uint8_t resistorRatio,   // Sets ST7565's resistor ratio, 0..7
     uint8_t volume)          // Sets ST7565's "volume" (contrast?), 0..0x3F
 {
+    task_t t;
+
+    TASK_RUN(&t, lcdInitTask(&t, resistorRatio, volume, NULL));
+}
+
+// lcdInitTask() - lcdInit as a task (see task.h): rather than wait for the
+// controller's power circuits, it returns, and carries on when called
+// again. Call with the same arguments until it returns TASK_DONE.
+//
+// Display RAM can be written while the power circuits settle, so the
+// first frame (or, with frame NULL, zeros) is sent a page per call during
+// those waits, and the display is turned on with it already in place.
+// Each wait still lasts at least as long as before; the page writes fill
+// it, rather than adding to it.
+//
+uint8_t lcdInitTask(task_t *t, uint8_t resistorRatio, uint8_t volume,
+                    const uint8_t *frame)
+{
+    TASK_BEGIN(t);
+
+    cur->resistorRatio = resistorRatio;
+    cur->volume = volume;
+
     CS1n_HI();         // De-select controller
     RESn_LO();         // Activate reset 
-    delay_ms(5);
+    TASK_DELAY_MS(t, 5);
     RESn_HI();         // Release reset
-    delay_ms(5);
+    TASK_DELAY_MS(t, 5);
 
-    lcdCmd(cADC_NORMAL);            // Normal segment order
-    lcdCmd(cCOM_NORMAL);            // Normal common order
+    lcdSetOrientation(cur->orientation); // Segment & common order
     lcdCmd(cBIAS_9);                // Set 1/9 bias
+    t->i = 0;                       // (Pages of the frame sent)
 
-    delay_ms(2);
+    INIT_WAIT_MS(t, 2, frame);
 
-    //lcdCmd(cDISP_START_LINE | 0);   // Start line is line 0
+    cur->startLine = 0;
+    lcdCmd(cDISP_START_LINE | 0);   // Start line is line 0
  
     lcdCmd(cBOOSTRATIO);            // Enter boost ratio set mode, and then...
     lcdCmd(0);                      //   set boost ratio to 2x/3x/4x
@@ -125,16 +206,15 @@ void lcdInit(
     // is probably not req'd. i.e. You can just turn on boost, regulator, and
     // follower all at once).
     lcdCmd(cPOWER_CONTROL | 4);     // Booster on.
-    delay_ms(5);
+    INIT_WAIT_MS(t, 5, frame);
     lcdCmd(cPOWER_CONTROL | 6);     // Boost, regulator on.
-    delay_ms(5);
+    INIT_WAIT_MS(t, 5, frame);
     lcdCmd(cPOWER_CONTROL | 7);     // Power boost, regulator, and follower all on
-    delay_ms(5);
+    INIT_WAIT_MS(t, 5, frame);
 
  	// Contrast/Brightness settings
-    resistorRatio &= 0x07;          // Limit to 0..7 or less
-    lcdCmd(cRESISTOR_RATIO | resistorRatio);
-    delay_ms(2);
+    lcdCmd(cRESISTOR_RATIO | (resistorRatio & 0x07));   // Limit to 0..7
+    INIT_WAIT_MS(t, 2, frame);
     lcdCmd(cVOLUME);                // Volume register set (LCD voltage, Vo). Next byte is...
     lcdCmd(volume & 0x3F);          //    the "volume", 0..63 (0x00..0x3f).
 /*
@@ -157,10 +237,18 @@ void lcdInit(
   #error must define port setup macro
 #endif
 */
-    delay_ms(2);
+    INIT_WAIT_MS(t, 2, frame);
+
+    // Any pages the waits didn't cover
+    while(t->i < cur->pages)
+    {
+        initPage(t->i++, frame);
+        TASK_YIELD(t);
+    }
+
     lcdCmd(cDISPLAY_ON);            // Turn display on
- 
-    lcdClear();                     // Write all zeros to display RAM
+
+    TASK_END(t);
 }
 
 // Serial (SPI) Mode Interface
@@ -175,222 +263,526 @@ void lcdInit(
 //   SCL  - Serial Clock (max @ Vdd 2.7v is T=100ns; F=10MHz)
 //   /RES - Reset (>1us pulse; wait 1us after)
 
-uint8_t lcdCmd(uint8_t cmd)
+// One transfer: /CS1 low, n bytes out (A0 low: commands; high: display
+// data), /CS1 high, and a pause of padUs before the next
+static void writeBytes(uint8_t a0, const uint8_t data[], int n, uint16_t padUs)
 {
-    A0_LO();
-    delay_us(5);
+    waitPad();
+    lcdBusPin(&cur->a0, a0);
+    lcdBusDelayUs(5);
 
     CS1n_LO();
-    delay_us(5);
-    
-#if defined LCD_SERIAL
-    SpiChnPutC(LCD_SPI_CH, cmd);
-	// TODO:  YUCK!! We have to wait for the SPI byte to have
-	//        been sent, before we continue (with raising CS1n).
-	//        Find a way to wait for Tx complete, or rework.
-	//delay_us(250);
-    while(LCD_SPIBUSY);   // Seems to work, but still have to wait some...
-    delay_us(15);                  // This fails at 5us; passes at 10 (M4492)
-#elif defined LCD_PARALLEL
-    uint16_t tmp16 = LCD_DB & 0xff00;
-    tmp16 |= cmd;
-    LCD_DB = tmp16;
-	delay_us(5);
-    WRn_LO();
-	delay_us(5);
-    WRn_HI();
-	delay_us(5);
-#else
-    #error Need to define LCD_SERIAL or LCD_PARALLEL
-#endif
+    lcdBusDelayUs(5);
 
-    CS1n_HI();
-	delay_us(25);  // Atmel test board has ~28us here
+    lcdBusWrite(cur, data, n);
 
-    return 0;
+    CS1n_HI();
+    PAD_US(padUs);
 }
 
-uint8_t lcdData(uint8_t data)
+// As writeBytes, reading a byte in (0 if the bus can't read)
+static uint8_t readByte(uint8_t a0)
 {
-    A0_HI();
-    delay_us(5);
+#if !LCD_BUS_CAN_READ
+    return 0;
+#else
+    uint8_t d;
+
+    lcdBusDir(1);
+
+    waitPad();
+    lcdBusPin(&cur->a0, a0);
+    lcdBusDelayUs(5);
 
     CS1n_LO();
-    delay_us(5);
-    
-#if defined LCD_SERIAL
-    SpiChnPutC(LCD_SPI_CH, data);
-	// TODO:  YUCK!! We have to wait for the SPI byte to have
-	//        been sent, before we continue (with raising CS1n).
-	//        Find a way to wait for Tx complete, or rework.
-	//delay_us(250);
-    while(LCD_SPIBUSY);   // Seems to work, but still have to wait some...
-    delay_us(15);                  // This fails at 5us; passes at 10 (M4492)
-#elif defined LCD_PARALLEL
-    uint16_t tmp16 = LCD_DB & 0xff00;
-    tmp16 |= data;
-    LCD_DB = tmp16;
-	delay_us(5);
-    WRn_LO();
-	delay_us(5);
-    WRn_HI();
-	delay_us(5);
-#else
-    #error Need to define LCD_SERIAL or LCD_PARALLEL
-#endif
+    lcdBusDelayUs(5);
+
+    d = lcdBusRead(cur);
 
     CS1n_HI();
-	delay_us(10);
+    PAD_US(5);
 
+    lcdBusDir(0);
+
+    return d;
+#endif
+}
+
+uint8_t lcdCmd(uint8_t cmd)
+{
+    writeBytes(0, &cmd, 1, 25);     // Atmel test board has ~28us of pad
     return 0;
 }
 
+uint8_t lcdData(uint8_t data)
+{
+    writeBytes(1, &data, 1, 10);
+    return 0;
+}
 
 uint8_t lcdDataArray(const uint8_t data[], int n)
 {
-    int i;
+    writeBytes(1, data, n, 10);
+    return 0;
+}
 
-    A0_HI();
-    delay_us(5);
+uint8_t lcdReadStatus()
+{
+    return readByte(0);
+}
 
-    CS1n_LO();
-    delay_us(5);
-    
-#if defined LCD_SERIAL
-    for(i=0; i<n; i++)
+uint8_t lcdReadData()
+{
+    return readByte(1);
+}
+
+
+// The commands that point the controller at a page and column, for
+// display data transfers: page, then column MS and LS nybbles (n = 0..2).
+//
+static uint8_t addrCmd(uint8_t page, uint8_t col, uint8_t n)
+{
+    col += cur->colOffset;
+    switch(n)
     {
-        SpiChnPutC(LCD_SPI_CH, data[i]);
-        // TODO:  YUCK!! We have to wait for the SPI byte to have
-        //        been sent, before we continue (with raising CS1n).
-        //        Find a way to wait for Tx complete, or rework.
-        //delay_us(250);
-        while(LCD_SPIBUSY);   // Seems to work, but still have to wait some...
+    case 0:  return cPAGE   | (cur->pages - 1 - page);  // Bottom page first
+    case 1:  return cCOL_MS | (col >> 4);
+    default: return cCOL_LS | (col & 0x0f);
     }
-    delay_us(15);                  // This fails at 5us; passes at 10 (M4492)
-#elif defined LCD_PARALLEL
-    uint16_t tmp16;
-    for(i=0; i<n; i++)
+}
+
+static void setAddress(uint8_t page, uint8_t col)
+{
+    uint8_t n;
+
+    for(n = 0; n < 3; n++)
+        lcdCmd(addrCmd(page, col, n));
+}
+
+// Transpose an 8x8 bit block, for rotating by 90 degrees.
+//
+// in[] is 8 columns (stride bytes apart) of a portrait page; out[] gets the
+// 8 landscape columns covering the same pixels, so that
+//     out[k] bit (7-m)  =  in[m] bit k
+// Done a word at a time, swapping 1x1, 2x2, then 4x4 bit sub-blocks
+// (Hacker's Delight, 7-3), with the rows reversed on the way out.
+//
+static void transpose8(const uint8_t *in, int stride, uint8_t out[8])
+{
+    uint32_t x, y, t;
+
+    x = ((uint32_t)in[0] << 24) | ((uint32_t)in[stride] << 16) |
+        ((uint32_t)in[2*stride] << 8) | in[3*stride];
+    y = ((uint32_t)in[4*stride] << 24) | ((uint32_t)in[5*stride] << 16) |
+        ((uint32_t)in[6*stride] << 8) | in[7*stride];
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    out[7] = x >> 24; out[6] = x >> 16; out[5] = x >> 8; out[4] = x;
+    out[3] = y >> 24; out[2] = y >> 16; out[1] = y >> 8; out[0] = y;
+}
+
+// Copy a buffer from our memory to LCD's display RAM.
+//
+// At 0/180 degrees, buff is 128x64 (8 pages of 128 bytes). At 90/270, it
+// is a 64x128 portrait bitmap (16 pages of 64 bytes), rotated here: each
+// landscape page is built from 8x8 blocks, one from each portrait page.
+// (For a panel of another size, its width x pages*8, or the other way up.)
+//
+void lcdWriteBuffer(const uint8_t *buff)
+{
+    task_t t;
+
+    TASK_RUN(&t, lcdFlushTask(&t, buff));
+}
+
+// lcdFlushTask() - lcdWriteBuffer as a task (see task.h): one page per
+// call, so other tasks get a turn in between. Call with the same buffer
+// until it returns TASK_DONE.
+//
+uint8_t lcdFlushTask(task_t *t, const uint8_t *buff)
+{
+    TASK_BEGIN(t);
+
+    for(t->i = 0; t->i < cur->pages; t->i++)
     {
-        tmp16 = LCD_DB & 0xff00;
-        tmp16 |= data[i];
-        LCD_DB = tmp16;
-        delay_us(5);
-        WRn_LO();
-        delay_us(5);
-        WRn_HI();
-        delay_us(5);
+        writePage(t->i, buff);
+        TASK_YIELD(t);
     }
-#else
-    #error Need to define LCD_SERIAL or LCD_PARALLEL
-#endif
 
-    CS1n_HI();
-	delay_us(10);
+    TASK_END(t);
+}
 
-    return 0;
+// One (landscape) page of a whole-screen buffer, as lcdWriteBuffer sends
+// it: straight from buff, or rotated into row[].
+//
+static const uint8_t *pageData(uint8_t page, const uint8_t *buff,
+                               uint8_t row[LCD_MAX_WIDTH])
+{
+    uint8_t blk, nBlk = cur->width / 8;
+    int16_t stride = cur->pages * 8;    // Portrait bitmap's width
+
+    if(cur->orientation == LCD_ORIENT_0 || cur->orientation == LCD_ORIENT_180)
+        return &buff[page * cur->width];
+
+    // Landscape columns 8*blk.. come from portrait page nBlk-1-blk,
+    // columns 8*page..
+    for(blk = 0; blk < nBlk; blk++)
+        transpose8(&buff[(nBlk - 1 - blk) * stride + page * 8], 1,
+                   &row[blk * 8]);
+    return row;
 }
 
+// Write one (landscape) page of a whole-screen buffer, as lcdWriteBuffer
+//
+static void writePage(uint8_t page, const uint8_t *buff)
+{
+    uint8_t row[LCD_MAX_WIDTH];
+
+    lcdWriteSpan(page, 0, pageData(page, buff, row), cur->width);
+}
 
-uint8_t lcdReadStatus()
+// lcdWriteBufferSpan() - Columns col0..col1 of one page of a whole-screen
+// buffer, as lcdWriteBuffer would send them. In portrait, the portrait
+// page is a column of 8x8 blocks in landscape; each block the span
+// touches is rotated and sent. Returns the number of data bytes sent.
+//
+uint16_t lcdWriteBufferSpan(const uint8_t *buff, uint8_t page,
+                            uint8_t col0, uint8_t col1)
 {
-#ifdef LCD_SERIAL
-    return 0;
-#else
-    uint16_t tmp16;
+    uint8_t out[8], lp, nBlk = cur->width / 8;
+    int16_t stride = cur->pages * 8;    // Portrait bitmap's width
+    uint16_t sent = 0;
 
-    TRISESET = 0x00ff;  // TODO: move this
+    if(col0 > col1) return 0;
 
-    A0_LO();
-    delay_us(5);
+    if(cur->orientation == LCD_ORIENT_0 || cur->orientation == LCD_ORIENT_180)
+    {
+        lcdWriteSpan(page, col0, &buff[page * cur->width + col0],
+                     col1 - col0 + 1);
+        return col1 - col0 + 1;
+    }
 
-    CS1n_LO();
-    delay_us(5);
+    // Portrait page "page" is landscape columns 8*(nBlk-1-page).., and its
+    // columns 8*lp.. are in landscape page lp
+    for(lp = col0 / 8; lp <= col1 / 8; lp++)
+    {
+        transpose8(&buff[page * stride + lp * 8], 1, out);
+        lcdWriteSpan(lp, (nBlk - 1 - page) * 8, out, 8);
+        sent += 8;
+    }
+    return sent;
+}
 
-    RDn_LO();
-	delay_us(5);
-    tmp16 = LCD_DB;
-    RDn_HI();
-	delay_us(5);
+// lcdGetSize() - The bitmap size lcdWriteBuffer takes, for the selected
+// panel in its current orientation
+//
+void lcdGetSize(int16_t *width, int16_t *height)
+{
+    if(cur->orientation == LCD_ORIENT_0 || cur->orientation == LCD_ORIENT_180) {
+        *width = cur->width;
+        *height = cur->pages * 8;
+    } else {
+        *width = cur->pages * 8;
+        *height = cur->width;
+    }
+}
 
-    CS1n_HI();
-	delay_us(5);
+// lcdSetOrientation() - Rotate the display.
+//
+// 180 degrees is done by the controller (reversed segment and common
+// order). 90 degrees is done by lcdWriteBuffer, and 270 is both. Takes
+// effect on the next lcdWriteBuffer.
+//
+void lcdSetOrientation(uint8_t orient)
+{
+    uint8_t flip = (orient == LCD_ORIENT_180 || orient == LCD_ORIENT_270);
 
-    TRISECLR = 0x00ff;  // TODO: move this
+    cur->orientation = orient;
+    // Reversed, segment 131 is column 0 (and the last 132 - width unused)
+    cur->colOffset = flip ? LCD_MAX_WIDTH - cur->width : 0;
 
-    return (uint8_t)tmp16;
-#endif
+    lcdCmd(flip ? cADC_REVERSE : cADC_NORMAL);
+    lcdCmd(flip ? cCOM_REVERSE : cCOM_NORMAL);
 }
 
-uint8_t lcdReadData()
+// Write an array of display data to one page, from a given column on.
+//
+void lcdWriteSpan(uint8_t page, uint8_t col, const uint8_t data[], int n)
 {
-#if defined LCD_SERIAL
-    return 0;
+    setAddress(page, col);
+    lcdDataArray(data, n);
+}
+
+// lcdSetStartLine() - Set the display RAM line shown on the first COM
+// line. Since our page order is reversed (see lcdWriteSpan), moving the
+// start line down by 8 moves the image up by one page, and the page that
+// appears at the bottom is the one that was at the top.
+//
+void lcdSetStartLine(uint8_t line)
+{
+    cur->startLine = line & 0x3f;
+    lcdCmd(cDISP_START_LINE | cur->startLine);
+}
+
+// lcdModifySpan() - Set or clear bits in display RAM, without a copy of
+// the display in our memory.
+//
+// In read-modify-write mode, reads don't advance the column address but
+// writes do, so each column is: dummy read, read, write back. RMW_END
+// returns the column address to where RMW_BEGIN was issued.
+//
+uint8_t lcdModifySpan(uint8_t page, uint8_t col,
+                      const uint8_t mask[], int n, uint8_t color)
+{
+#if !LCD_BUS_CAN_READ
+    return 1;   // Write-only (serial mode)
 #else
-    uint16_t tmp16;
+    int i;
+    uint8_t d;
 
-    TRISESET = 0x00ff;  // TODO: move this
+    setAddress(page, col);
+    lcdCmd(cRMW_BEGIN);
 
-    A0_HI();
-    delay_us(5);
+    for(i=0; i<n; i++)
+    {
+        lcdReadData();              // Dummy read, per the datasheet
+        d = lcdReadData();
+        if(color) d |= mask[i];
+        else      d &= ~mask[i];
+        lcdData(d);
+    }
 
-    CS1n_LO();
-    delay_us(5);
+    lcdCmd(cRMW_END);
+    return 0;
+#endif
+}
 
-    RDn_LO();
-	delay_us(5);
-    tmp16 = LCD_DB;
-    RDn_HI();
-	delay_us(5);
+// Write zeros to one page of display RAM (all 132 segments)
+//
+static void clearPage(uint8_t page)
+{
+    static const uint8_t zeros[132];
 
-    CS1n_HI();
-	delay_us(5);
+    lcdCmd(cPAGE | page);
+    lcdCmd(cCOL_MS);
+    lcdCmd(cCOL_LS);
+    //lcdCmd(cRMW);    // TODO: Why was this here?
+    //lcdData(0xff);   //
 
-    TRISECLR = 0x00ff;  // TODO: move this
+    // One burst, rather than a byte (and a chip-select cycle) at a time
+    lcdDataArray(zeros, sizeof(zeros));
+}
 
-    return (uint8_t)tmp16;
-#endif
+// lcdClear() - Write all zeros to display RAM
+//
+void lcdClear(void)
+{
+    uint16_t page;
+
+    for(page=0; page<8; page++)
+        clearPage(page);
 }
 
 
-// Copy a buffer from our memory to LCD's display RAM.
-// TODO: Different LCD sizes, orientations, etc.
+// lcdSelect() - Direct the lcd calls that follow to another panel.
+// Returns the panel that was selected.
 //
-void lcdWriteBuffer(const uint8_t *buff)
+lcdPanel_t *lcdSelect(lcdPanel_t *panel)
 {
-    //uint8_t col
-	uint8_t page;
+    lcdPanel_t *was = cur;
+
+    cur = panel;
+    return was;
+}
+
+// lcdPanelInitTask() - lcdInitTask for a given panel, with its contrast
+// settings. Several panels' tasks can run side by side, each with its
+// own task_t (see lcdInitTask): the panel is selected for each call.
+//
+uint8_t lcdPanelInitTask(task_t *t, lcdPanel_t *panel, const uint8_t *frame)
+{
+    lcdPanel_t *was = lcdSelect(panel);
+    uint8_t ret;
+
+    ret = lcdInitTask(t, panel->resistorRatio, panel->volume, frame);
+    lcdSelect(was);
+    return ret;
+}
 
-    for(page = 0; page < 8; page++)
+// lcdWriteBuffers() - lcdWriteBuffer for n panels at once, buffs[k] to
+// panels[k].
+//
+// The panels are written a page at a time, with their transfers taken in
+// turn: page address commands to each panel, then the page's data to
+// each. Every transfer ends with a pause (see PAD_US) before that panel
+// will take another, and it's spent on the other panels' transfers,
+// rather than waiting: on a shared bus, n panels take little longer than
+// one.
+//
+void lcdWriteBuffers(lcdPanel_t *const panels[], const uint8_t *const buffs[],
+                     uint8_t n)
+{
+    task_t t;
+
+    TASK_RUN(&t, lcdFlushPanelsTask(&t, panels, buffs, n));
+}
+
+// lcdFlushPanelsTask() - lcdWriteBuffers as a task: one page (of every
+// panel) per call, until TASK_DONE.
+//
+uint8_t lcdFlushPanelsTask(task_t *t, lcdPanel_t *const panels[],
+                           const uint8_t *const buffs[], uint8_t n)
+{
+    static uint8_t rows[LCD_MAX_PANELS][LCD_MAX_WIDTH];
+    const uint8_t *data[LCD_MAX_PANELS];
+    lcdPanel_t *was = cur;
+    uint8_t k, step, pages = 0;
+
+    if(n > LCD_MAX_PANELS) n = LCD_MAX_PANELS;
+    for(k = 0; k < n; k++)              // The tallest panel's pages
+        if(panels[k]->pages > pages)
+            pages = panels[k]->pages;
+
+    TASK_BEGIN(t);
+
+    for(t->i = 0; t->i < pages; t->i++)
     {
-        lcdCmd(cPAGE    | (7 - page));  // Lines need to be reversed. (Why?)
-        lcdCmd(cCOL_MS  | 0);
-        lcdCmd(cCOL_LS  | 0);
+        for(k = 0; k < n; k++) {
+            cur = panels[k];
+            if(t->i < cur->pages)
+                data[k] = pageData(t->i, buffs[k], rows[k]);
+        }
+
+        // Three address commands, then the data
+        for(step = 0; step < 4; step++)
+        {
+            for(k = 0; k < n; k++)
+            {
+                cur = panels[k];
+                if(t->i >= cur->pages)
+                    continue;
+                if(step < 3)
+                    lcdCmd(addrCmd(t->i, 0, step));
+                else
+                    lcdDataArray(data[k], cur->width);
+            }
+        }
+        cur = was;
+        TASK_YIELD(t);
+    }
+
+    TASK_END(t);
+}
+
+
+//
+// Self-healing refresh
+//
+// The operating modes are re-sent a group at a time, as lcdInit left
+// them (with the current orientation and start line), and display RAM is
+// rewritten from the bitmap a page at a time, so a panel that has been
+// scrambled (by ESD, say) comes right within a cycle of steps, without a
+// blank or a re-init. In parallel mode, the status is read each step, and
+// each page is read back after it's written; if either is wrong, all the
+// modes are re-sent at once.
+//
+
+#define MODE_GROUPS 9
 
-        //lcdCmd(cRMW);   // Why was this here?
-        //lcdData(0xff);     //
+// Re-send mode group n (0..MODE_GROUPS-1)
+static void assertMode(uint8_t n)
+{
+    uint8_t flip = (cur->orientation == LCD_ORIENT_180 ||
+                    cur->orientation == LCD_ORIENT_270);
 
-        //for(col=0; col<128; col++)
-        //    lcdData(*buff++);
-        lcdDataArray(buff, 128);
-        buff += 128;
+    switch(n)
+    {
+    case 0: lcdCmd(flip ? cADC_REVERSE : cADC_NORMAL);         break;
+    case 1: lcdCmd(flip ? cCOM_REVERSE : cCOM_NORMAL);         break;
+    case 2: lcdCmd(cBIAS_9);                                   break;
+    case 3: lcdCmd(cBOOSTRATIO); lcdCmd(0);                    break;
+    case 4: lcdCmd(cPOWER_CONTROL | 7);                        break;
+    case 5: lcdCmd(cRESISTOR_RATIO | (cur->resistorRatio & 0x07)); break;
+    case 6: lcdCmd(cVOLUME); lcdCmd(cur->volume & 0x3F);       break;
+    case 7: lcdCmd(cDISP_START_LINE | cur->startLine);         break;
+    default: lcdCmd(cDISPLAY_ON);                              break;
     }
 }
 
-// lcdClear() - Write all zeros to display RAM
+// True if the controller's status shows it has lost its settings (where it
+// can be read: not in serial mode)
+static uint8_t modeLost(void)
+{
+#if LCD_BUS_CAN_READ
+    uint8_t status = lcdReadStatus();
+    uint8_t flip = (cur->orientation == LCD_ORIENT_180 ||
+                    cur->orientation == LCD_ORIENT_270);
+
+    return (status & (sRESET | sOFF)) || ((status & sADC) == 0) != flip;
+#else
+    return 0;
+#endif
+}
+
+// True unless page "page" of display RAM differs from data[] (where it can
+// be read: not in serial mode)
+static uint8_t pageMatches(uint8_t page, const uint8_t *data)
+{
+#if LCD_BUS_CAN_READ
+    int i;
+
+    setAddress(page, 0);
+    lcdReadData();                  // Dummy read, per the datasheet
+    for(i = 0; i < cur->width; i++)
+        if(lcdReadData() != data[i])
+            return 0;
+#endif
+    return 1;
+}
+
+// lcdRefreshTask() - Run from the main loop; never finishes. Every
+// periodMs, re-sends one group of mode settings and rewrites one page of
+// the bitmap buff (as for lcdWriteBuffer; NULL for modes only).
 //
-void lcdClear(void)
+uint8_t lcdRefreshTask(task_t *t, const uint8_t *buff, uint16_t periodMs)
 {
-    uint16_t seg, page;
+    uint8_t row[LCD_MAX_WIDTH], page, n;
+    const uint8_t *data;
+    uint8_t lost;
 
-    for(page=0; page<8; page++)
+    TASK_BEGIN(t);
+
+    for(t->i = 0; ; t->i++)
     {
-        lcdCmd(cPAGE | page);
-        lcdCmd(cCOL_MS);
-        lcdCmd(cCOL_LS);
-        //lcdCmd(cRMW);    // TODO: Why was this here?
-        //lcdData(0xff);   //
-
-        for(seg=0; seg<132; seg++)
-            lcdData(0);
+        lost = modeLost();
+        if(buff) {
+            page = t->i % cur->pages;
+            data = pageData(page, buff, row);
+            lcdWriteSpan(page, 0, data, cur->width);
+            if(!pageMatches(page, data)) {
+                lcdWriteSpan(page, 0, data, cur->width);
+                lost = 1;
+            }
+        }
+
+        if(lost) {
+            cur->faults++;
+            for(n = 0; n < MODE_GROUPS; n++)
+                assertMode(n);
+        } else {
+            assertMode(t->i % MODE_GROUPS);
+        }
+
+        TASK_DELAY_MS(t, periodMs);
     }
+
+    TASK_END(t);
 }
@@ -6,6 +6,8 @@
 
 #include <stdint.h>
 
+#include "task.h"
+
 // Commands
 //
 // Some commands occupy a varying number of MS bits, with optional
@@ -45,6 +47,75 @@
                                 /*    2: 6x                                 */
 #define cNOP              0xE3
 
+// Status byte bits (lcdReadStatus, parallel mode)
+#define sBUSY             0x80  /* Busy with an operation       */
+#define sADC              0x40  /* Normal (not reversed) segment order */
+#define sOFF              0x20  /* Display is off               */
+#define sRESET            0x10  /* Being reset                  */
+
+// Panels
+//
+// Every lcd call goes to the selected panel (see lcdSelect). That starts
+// out as lcdPanel0, the board's display, wired as set up in st7565.c, so
+// code for one display needn't know about panels. Each further panel,
+// with its own chip select on the same SPI bus (or parallel data bus), is
+// described by an lcdPanel_t of its own, e.g.
+//
+//     lcdPanel_t rear = {
+//         { &LATDCLR, &LATDSET, BIT_10 },   // /CS
+//         { &LATFCLR, &LATFSET, BIT_5 },    // A0   (may be shared)
+//         { &LATFCLR, &LATFSET, BIT_4 },    // /RES (may be shared)
+//         SPI_CHANNEL2, 128, 8,             // Bus, width, pages
+//         4, 28, LCD_ORIENT_180             // Contrast, orientation
+//     };
+//
+// If /RES is shared, start the panels' lcdPanelInitTasks together. Give
+// each panel a bitmap of its own to draw in (gfxInitBand(w, h, buff, 0,
+// h/8) switches gfx to a bitmap without clearing it).
+//
+#define LCD_MAX_WIDTH   132     // Columns of display RAM
+#define LCD_MAX_PANELS  4       // For lcdWriteBuffers
+
+typedef struct {
+    volatile unsigned int *clr;   // Port's LATxCLR register...
+    volatile unsigned int *set;   //   and LATxSET
+    unsigned int bit;             // BIT_n
+} lcdPin_t;
+
+typedef struct {
+    lcdPin_t cs, a0, res;       // /CS1, A0 and /RES lines
+    uint8_t  spiChannel;        // SPI_CHANNELn (serial interface)
+    uint8_t  width;             // Columns, up to LCD_MAX_WIDTH
+    uint8_t  pages;             // Rows / 8, up to 8
+    uint8_t  resistorRatio;     // Contrast, for lcdPanelInitTask (and as
+    uint8_t  volume;            //   last set by lcdInit)
+    uint8_t  orientation;       // LCD_ORIENT_x, as set by lcdSetOrientation
+
+    // The driver's own, zero to start with
+    uint8_t  colOffset;         // First column, with segments reversed
+    uint8_t  startLine;         // As set by lcdSetStartLine
+    uint16_t faults;            // Times lcdRefreshTask found it scrambled
+    uint16_t pad;               // Ticks to wait from idleAt...
+    uint32_t idleAt;            //   before the next transfer
+} lcdPanel_t;
+
+extern lcdPanel_t lcdPanel0;
+
+// Select the panel the calls that follow go to. Returns the previous one.
+lcdPanel_t *lcdSelect(lcdPanel_t *panel);
+
+// lcdInitTask for a given panel, with the contrast in its descriptor
+uint8_t lcdPanelInitTask(task_t *t, lcdPanel_t *panel, const uint8_t *frame);
+
+// lcdWriteBuffer for n panels at once, with their transfers interleaved,
+// so each panel's pauses between transfers are spent on the others.
+void    lcdWriteBuffers(lcdPanel_t *const panels[],
+                        const uint8_t *const buffs[], uint8_t n);
+
+// lcdWriteBuffers as a cooperative task: a page per call, until TASK_DONE
+uint8_t lcdFlushPanelsTask(task_t *t, lcdPanel_t *const panels[],
+                           const uint8_t *const buffs[], uint8_t n);
+
 // lcdInit()
 //
 // Inputs are "contrast" parameters: The ST7565's resistor-ratio
@@ -54,6 +125,15 @@ void lcdInit(
     uint8_t resistorRatio,   // Sets ST7565's resistor ratio, 0..7
     uint8_t volume);         // Sets ST7565's "volume" (contrast?), 0..0x3F
 
+// lcdInit as a cooperative task (see task.h), so the power-up waits don't
+// hold up the rest of the program: call it from the main loop, or a timer
+// interrupt, with the same arguments until it returns TASK_DONE (t must
+// start out zeroed). The display comes on showing "frame" (a bitmap as
+// for lcdWriteBuffer), or blank if frame is NULL; the frame is sent while
+// the power circuits settle, so this costs no extra time.
+uint8_t lcdInitTask(task_t *t, uint8_t resistorRatio, uint8_t volume,
+                    const uint8_t *frame);
+
 
 // Send one of the LCD command bytes, as defined above
 uint8_t lcdCmd(uint8_t cmd);
@@ -75,5 +155,53 @@ void    lcdClear(void);
 // Copy a bitmap from memory to the LCD
 void    lcdWriteBuffer(const uint8_t *buff);
 
+// lcdWriteBuffer as a cooperative task: a page per call, until TASK_DONE
+uint8_t lcdFlushTask(task_t *t, const uint8_t *buff);
+
+// Part of lcdWriteBuffer: columns col0..col1 (inclusive) of one page of
+// buff, in the bitmap's own coordinates (portrait too). Returns the data
+// bytes sent.
+uint16_t lcdWriteBufferSpan(const uint8_t *buff, uint8_t page,
+                            uint8_t col0, uint8_t col1);
+
+// Width and height (pixels) of the bitmap lcdWriteBuffer takes now: the
+// panel's, turned by the orientation
+void    lcdGetSize(int16_t *width, int16_t *height);
+
+// Background refresh, for panels that get scrambled (e.g. by ESD): call
+// from the main loop; it never finishes. Every periodMs it re-sends one
+// group of the operating modes (as lcdInit set them) and rewrites one page
+// of display RAM from buff (NULL: modes only), so it costs the same small
+// slice each time, and the whole panel is renewed every 9 steps. In
+// parallel mode it also checks the status, and reads each page back; if
+// either is wrong, all the modes are re-sent at once, and the panel's
+// "faults" count goes up.
+uint8_t lcdRefreshTask(task_t *t, const uint8_t *buff, uint16_t periodMs);
+
+// Display orientations, for lcdSetOrientation() (clockwise rotation)
+#define LCD_ORIENT_0    0   // 128x64 landscape
+#define LCD_ORIENT_90   1   // 64x128 portrait
+#define LCD_ORIENT_180  2   // 128x64, upside down
+#define LCD_ORIENT_270  3   // 64x128, portrait the other way
+
+// Set the display orientation. In portrait, lcdWriteBuffer() takes a
+// 64x128 bitmap (i.e. gfxInit(64, 128, buff)). Spans and other partial
+// writes are in landscape coordinates, in every orientation.
+void    lcdSetOrientation(uint8_t orient);
+
+// Write n bytes of display data to one page, starting at column col.
+// Pages are numbered as in the lcdWriteBuffer() bitmap (0 is the top).
+void    lcdWriteSpan(uint8_t page, uint8_t col, const uint8_t data[], int n);
+
+// Set the display start line, 0..63. Rotates the displayed image vertically
+// without touching display RAM.
+void    lcdSetStartLine(uint8_t line);
+
+// Set (color != 0) or clear the bits in mask[] across n columns of one page,
+// starting at column col, with the controller's read-modify-write mode.
+// Parallel mode only: returns 1 and does nothing in serial mode.
+uint8_t lcdModifySpan(uint8_t page, uint8_t col,
+                      const uint8_t mask[], int n, uint8_t color);
+
 
 #endif
@@ -0,0 +1,81 @@
+#ifndef __TASK_H_
+#define __TASK_H_
+
+#include <stdint.h>
+
+#include "p32_utils.h"
+
+//
+// Cooperative tasks (protothread style)
+//
+// A task is a function that does a little work each time it is called,
+// and returns TASK_WAITING until it has finished, then TASK_DONE. Where
+// it would have waited, it returns instead, and carries on from there on
+// the next call. A main loop runs any number of tasks by calling each in
+// turn, so nothing blocks the others; no RTOS needed.
+//
+//     uint8_t blinkTask(task_t *t)
+//     {
+//         TASK_BEGIN(t);
+//         while(1) {
+//             LED_ON();
+//             TASK_DELAY_MS(t, 100);
+//             LED_OFF();
+//             TASK_DELAY_MS(t, 900);
+//         }
+//         TASK_END(t);
+//     }
+//
+// The place to carry on from is kept in a task_t, which must start out
+// zeroed (or TASK_INIT). Local variables don't survive a wait: keep such
+// state in statics, or in the task_t's loop counter. The TASK_ macros
+// can't be used from within a switch statement of the task's own, and
+// there can be only one per source line.
+//
+
+typedef struct {
+    uint16_t line;      // Where to carry on (0: the start)
+    uint16_t i;         // Loop counter, kept across waits
+    uint32_t due;       // Tick count a TASK_DELAY ends at
+} task_t;
+
+#define TASK_WAITING 0
+#define TASK_DONE    1
+
+#define TASK_INIT(t)   ((t)->line = 0)
+
+#define TASK_BEGIN(t)  switch((t)->line) { case 0:
+
+#define TASK_END(t)    } (t)->line = 0; return TASK_DONE
+
+// Finish now (returns TASK_DONE)
+#define TASK_EXIT(t)   do { (t)->line = 0; return TASK_DONE; } while(0)
+
+// Give the other tasks a turn
+#define TASK_YIELD(t)                                           \
+    do { (t)->line = __LINE__; return TASK_WAITING;             \
+         case __LINE__:; } while(0)
+
+// Wait (letting other tasks run) until cond is true
+#define TASK_WAIT_UNTIL(t, cond)                                \
+    do { (t)->line = __LINE__; case __LINE__:                   \
+         if(!(cond)) return TASK_WAITING; } while(0)
+
+// Wait a number of ticks (see tickNow), us or ms
+#define TASK_DELAY_TICKS(t, n)                                  \
+    do { (t)->due = tickNow() + (n);                            \
+         TASK_WAIT_UNTIL(t, tickExpired((t)->due)); } while(0)
+
+#define TASK_DELAY_US(t, us)  TASK_DELAY_TICKS(t, tickFromUs(us))
+#define TASK_DELAY_MS(t, ms)  TASK_DELAY_TICKS(t, tickFromMs(ms))
+
+// Run another task (child, with its own task_t) until it's done
+#define TASK_SPAWN(t, child, call)                              \
+    do { TASK_INIT(child);                                      \
+         TASK_WAIT_UNTIL(t, (call) != TASK_WAITING); } while(0)
+
+// Run a task to the end, here and now (blocking)
+#define TASK_RUN(t, call)                                       \
+    do { TASK_INIT(t); while((call) == TASK_WAITING); } while(0)
+
+#endif
@@ -0,0 +1,102 @@
+//
+// benchBigText - Scaled text (gfxBigChar): every CP437 character at every
+// scale, at random places, in a bitmap and by RMW, matches the glyph drawn
+// as scale x scale blocks; and characters per second on the host, aligned
+// to a page and not, against drawing those blocks one by one.
+//
+// Build from this directory with:
+//     cc -O2 -I. -I.. -o benchBigText benchBigText.c mock.c ../gfx.c
+//        ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "gfxFont.h"
+#include "st7565.h"
+
+#define CHARS 200000
+
+static uint8_t bitmap[1024], reference[1024];
+
+// The character as blocks of scale x scale pixels, one per font pixel
+static void blocks(int16_t x, int16_t y, uint8_t c, uint8_t s)
+{
+    const uint8_t *glyph = gfxFontByte(&gfxFont5x8, c);
+    int16_t i, r;
+
+    for(i = 0; i < 5; i++)
+        for(r = 0; r < 8; r++)
+            gfxFRect(x + i * s, y + r * s, x + i * s + s - 1, y + r * s + s - 1,
+                     (glyph[i] >> (7 - r)) & 1);
+}
+
+static double perSecond(clock_t start, long n)
+{
+    return n / ((double)(clock() - start) / CLOCKS_PER_SEC);
+}
+
+int main(void)
+{
+    clock_t start;
+    double fast, slow;
+    int t, x, y, same;
+    uint8_t s, c, unaligned;
+    long i;
+
+    srand(1);
+    lcdInit(5, 35);
+
+    for(same = 1, t = 0; t < 6000; t++)
+    {
+        s = 1 + t % 4;
+        x = rand() % 140 - 10;
+        y = rand() % 80 - 10;
+        c = rand();
+
+        gfxInit(128, 64, reference);
+        gfxFill(0x5A);
+        blocks(x, y, c, s);
+
+        if(t & 1) {
+            gfxInit(128, 64, NULL);
+            gfxFill(0x5A);
+            gfxBigChar(x, y, c, s);
+            same &= mockLcdShows(reference);
+        }
+        else {
+            gfxInit(128, 64, bitmap);
+            gfxFill(0x5A);
+            gfxBigChar(x, y, c, s);
+            same &= !memcmp(bitmap, reference, sizeof(bitmap));
+        }
+    }
+    CHECK(same);
+
+    gfxInit(128, 64, bitmap);
+    printf("chars per second     gfxBigChar     blocks\n");
+    for(s = 1; s <= 4; s++)
+        for(unaligned = 0; unaligned < 2; unaligned++)
+        {
+            y = unaligned ? 3 : 8;
+            start = clock();
+            for(i = 0; i < CHARS; i++)
+                gfxBigChar(i % (128 - 6 * s), y, '0' + i % 10, s);
+            fast = perSecond(start, CHARS);
+
+            start = clock();
+            for(i = 0; i < CHARS / 20; i++)
+                blocks(i % (128 - 6 * s), y, '0' + i % 10, s);
+            slow = perSecond(start, CHARS / 20);
+
+            printf("%dx %-9s %14.0f %10.0f\n", s,
+                   unaligned ? "unaligned" : "aligned", fast, slow);
+        }
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchBigText");
+}
@@ -0,0 +1,79 @@
+//
+// benchDither - Dithering (gfxDither.c): flat grays come out with the
+// right share of pixels on, whole images drawn to the bitmap and to the
+// LCD agree, and the host time per 128x64 frame for each method.
+//
+// Build from this directory with:
+//     cc -O2 -I. -I.. -o benchDither benchDither.c mock.c ../gfxDither.c
+//        ../gfx.c ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "gfxDither.h"
+#include "st7565.h"
+
+#define FRAMES 20000
+
+static uint8_t gray[64][128], page[128], bitmap[1024];
+
+static int bitsOn(uint8_t b)
+{
+    int n = 0;
+
+    for(; b; b &= b - 1)
+        n++;
+    return n;
+}
+
+int main(void)
+{
+    static const char *const name[2] = { "Bayer", "Floyd-Steinberg" };
+    clock_t start;
+    double us;
+    int m, g, x, y, on;
+
+    lcdInit(5, 35);
+    gfxInit(128, 64, bitmap);
+
+    // Flat grays: pixels on in proportion to darkness, within 1%
+    for(m = GFX_DITHER_BAYER; m <= GFX_DITHER_FS; m++)
+        for(g = 0; g <= 255; g += 51)
+        {
+            memset(gray, g, sizeof(gray));
+            gfxDitherBegin(m, 128, page);
+            for(on = 0, y = 0; y < 64; y++)
+                if(gfxDitherRow(gray[y]))
+                    for(x = 0; x < 128; x++)
+                        on += bitsOn(page[x]);
+            CHECK(on >= 8192 * (255 - g) / 255 - 82 &&
+                  on <= 8192 * (255 - g) / 255 + 82);
+        }
+
+    // A gradient, each way, to the bitmap and to the LCD
+    for(y = 0; y < 64; y++)
+        for(x = 0; x < 128; x++)
+            gray[y][x] = x * 2;
+    for(m = GFX_DITHER_BAYER; m <= GFX_DITHER_FS; m++)
+    {
+        gfxDitherDraw(m, &gray[0][0], 128, 64, 128, 0, 0);
+        gfxDitherToLcd(m, &gray[0][0], 128, 64, 128, 0, 0);
+        CHECK(mockLcdShows(bitmap));
+
+        start = clock();
+        for(g = 0; g < FRAMES; g++) {
+            gfxDitherBegin(m, 128, page);
+            for(y = 0; y < 64; y++)
+                gfxDitherRow(gray[y]);
+        }
+        us = (double)(clock() - start) / CLOCKS_PER_SEC / FRAMES * 1e6;
+        printf("%-16s %.1f us per 128x64 frame\n", name[m], us);
+    }
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchDither");
+}
@@ -0,0 +1,158 @@
+//
+// benchImage - Compressed images (gfxImage.c): for a few kinds of picture,
+// drawn here with gfx, the compressed size against the 1024-byte bitmap,
+// that decoding gives the picture back (in a bitmap, and on the glass), and
+// the host time to decode.
+//
+// Build from this directory with:
+//     cc -O2 -I. -I.. -o benchImage benchImage.c mock.c ../gfxImage.c
+//        ../gfx.c ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "gfxImage.h"
+#include "st7565.h"
+
+#define DECODES 100000
+
+static uint8_t picture[1024], bitmap[1024];
+static uint8_t image[2 + 2 * 1024];
+static int imageLen;
+
+// Compress one page, as tools/pbm2img does (greedy): copy-above runs of
+// 2+, repeats of 3+, otherwise literals
+static void encodePage(const uint8_t *cur, const uint8_t *above, int w)
+{
+    int i = 0, j, n, lit;
+
+    while(i < w)
+    {
+        for(n = 0; i + n < w && n < 128 && cur[i + n] == above[i + n]; n++) ;
+        if(n >= 2 || (n == 1 && i + 1 == w)) {
+            image[imageLen++] = 0x80 | (n - 1);
+            i += n;
+            continue;
+        }
+
+        for(n = 1; i + n < w && n < 65 && cur[i + n] == cur[i]; n++) ;
+        if(n >= 3) {
+            image[imageLen++] = 0x40 | (n - 2);
+            image[imageLen++] = cur[i];
+            i += n;
+            continue;
+        }
+
+        for(lit = 1; i + lit < w && lit < 64; lit++)
+        {
+            j = i + lit;
+            if(j + 1 < w && cur[j] == above[j] && cur[j + 1] == above[j + 1]) break;
+            if(j + 2 < w && cur[j] == cur[j + 1] && cur[j] == cur[j + 2]) break;
+        }
+        image[imageLen++] = lit - 1;
+        memcpy(&image[imageLen], &cur[i], lit);
+        imageLen += lit;
+        i += lit;
+    }
+}
+
+static void encode(void)
+{
+    static const uint8_t zeros[128];
+    int page;
+
+    image[0] = 128;
+    image[1] = 8;
+    imageLen = 2;
+    for(page = 0; page < 8; page++)
+        encodePage(&picture[page * 128], page ? &picture[(page - 1) * 128] : zeros, 128);
+}
+
+static void splash(void)
+{
+    gfxRect(0, 0, 127, 63, 1);
+    gfxFCircle(24, 32, 16, 1);
+    gfxCircle(24, 32, 20, 1);
+    gfxBigString(50, 12, "LCD", 2);
+    gfxString(50, 5, "Version 1.0");
+}
+
+static void icons(void)
+{
+    int i;
+
+    for(i = 0; i < 8; i++) {
+        gfxRect(4 + i * 15, 8, 15 + i * 15, 19, 1);
+        gfxFCircle(9 + i * 15, 40, 2 + i % 4, 1);
+        gfxChar(7 + i * 15, 7, 'A' + i);
+    }
+}
+
+static void chart(void)
+{
+    int16_t xy[2 * 128];
+    int i;
+
+    for(i = 0; i < 128; i += 16)
+        gfxLine(i, 0, i, 63, 1);
+    for(i = 0; i < 64; i += 16)
+        gfxLine(0, i, 127, i, 1);
+    for(i = 0; i < 128; i++) {
+        xy[2 * i] = i;
+        xy[2 * i + 1] = 32 + (i * 7 % 23) - 11;
+    }
+    gfxPolyline(128, xy, 1);
+}
+
+static void noise(void)
+{
+    int i;
+
+    srand(4);
+    for(i = 0; i < 1024; i++)
+        picture[i] = rand();
+}
+
+static void bench(const char *name, void (*draw)(void))
+{
+    clock_t start;
+    double us;
+    int i;
+
+    gfxInit(128, 64, picture);
+    draw();
+    encode();
+
+    gfxInit(128, 64, bitmap);
+    gfxImageDraw(0, 0, image);
+    CHECK(!memcmp(bitmap, picture, sizeof(bitmap)));
+    gfxImageToLcd(0, 0, image);
+    CHECK(mockLcdShows(picture));
+
+    start = clock();
+    for(i = 0; i < DECODES; i++)
+        gfxImageDraw(0, 0, image);
+    us = (double)(clock() - start) / CLOCKS_PER_SEC / DECODES * 1e6;
+
+    printf("%-8s %4d bytes (%4.1f:1)  decode %.2f us\n",
+           name, imageLen, 1024.0 / imageLen, us);
+}
+
+int main(void)
+{
+    lcdInit(5, 35);
+
+    bench("splash", splash);
+    bench("icons", icons);
+    bench("chart", chart);
+    bench("noise", noise);
+    CHECK(imageLen <= 2 + 1024 + 8 * 2);    // (Noise: literals, at worst)
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchImage");
+}
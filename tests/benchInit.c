@@ -0,0 +1,64 @@
+//
+// benchInit - Bringing the LCD up (st7565.c), on the simulated clock: how
+// long until the first frame shows, blocking (lcdInit, then
+// lcdWriteBuffer) against lcdInitTask sending the frame during its
+// waits, and how many main loop turns (of 100 us other work each) the
+// task leaves meanwhile.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o benchInit benchInit.c mock.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mock.h"
+#include "p32_utils.h"
+#include "st7565.h"
+#include "task.h"
+
+#define TURN_US 100         // Other work per main loop turn
+
+static uint8_t bitmap[1024];
+
+static double msSince(uint32_t t0)
+{
+    return (mockTicks - t0) / (double)tickFromMs(1);
+}
+
+int main(void)
+{
+    task_t t = { 0 };
+    uint32_t t0;
+    double blocking, tasked;
+    long turns = 0;
+    int i;
+
+    for(i = 0; i < 1024; i++)
+        bitmap[i] = i * 13 + 1;
+
+    memset(mockLcd.ram, 0xAA, sizeof(mockLcd.ram));
+    t0 = mockTicks;
+    lcdInit(5, 35);
+    lcdWriteBuffer(bitmap);
+    blocking = msSince(t0);
+    CHECK(mockLcdShows(bitmap));
+
+    memset(mockLcd.ram, 0xAA, sizeof(mockLcd.ram));
+    t0 = mockTicks;
+    while(lcdInitTask(&t, 5, 35, bitmap) == TASK_WAITING) {
+        mockAdvanceUs(TURN_US);
+        turns++;
+    }
+    tasked = msSince(t0);
+    CHECK(mockLcdShows(bitmap));
+    CHECK(mockLcd.on);
+
+    printf("first frame: %.1f ms blocking, %.1f ms with lcdInitTask "
+           "(%ld turns free for other tasks)\n", blocking, tasked, turns);
+    CHECK(tasked < blocking);
+    CHECK(turns > 0);
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchInit");
+}
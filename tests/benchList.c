@@ -0,0 +1,103 @@
+//
+// benchList - Display lists (gfxList.c) against drawing the same frame
+// straight into a bitmap: the size of the list, the pages a render sends
+// (all of them first, none for an unchanged frame), that the glass shows
+// the same frame, and the host time per frame each way.
+//
+// Build from this directory with:
+//     cc -O2 -I. -I.. -o benchList benchList.c mock.c ../gfx.c ../gfxList.c
+//        ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "gfxList.h"
+#include "st7565.h"
+
+#define FRAMES 20000
+
+static uint8_t bitmap[1024], list[512], band[128];
+static const uint8_t img[16] = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16
+};
+
+static void direct(void)
+{
+    gfxFill(0);
+    gfxLine(0, 0, 127, 63, 1);
+    gfxRect(5, 5, 60, 40, 1);
+    gfxFCircle(90, 30, 20, 1);
+    gfxCircle(20, 50, 10, 1);
+    gfxString(0, 0, "Temp 23.5C");
+    gfxFRect(70, 50, 120, 60, 1);
+    gfxBitmap(100, 1, 8, 2, img);
+    gfxPixel(3, 60, 1);
+}
+
+static void record(void)
+{
+    gfxListClear();
+    gfxListLine(0, 0, 127, 63, 1);
+    gfxListRect(5, 5, 60, 40, 1);
+    gfxListFCircle(90, 30, 20, 1);
+    gfxListCircle(20, 50, 10, 1);
+    gfxListString(0, 0, "Temp 23.5C");
+    gfxListFRect(70, 50, 120, 60, 1);
+    gfxListBitmap(100, 1, 8, 2, img);
+    gfxListPixel(3, 60, 1);
+}
+
+static double usPerFrame(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC / FRAMES * 1e6;
+}
+
+int main(void)
+{
+    clock_t start;
+    double tDirect, tSend, tList;
+    int i;
+
+    lcdInit(5, 35);
+    gfxInit(128, 64, bitmap);
+    direct();
+
+    gfxListInit(list, sizeof(list), 128, 64, band);
+    record();
+    CHECK(!gfxListOverflow());
+    CHECK(gfxListRender() == 8);
+    CHECK(mockLcdShows(bitmap));
+    CHECK(gfxListRender() == 0);            // Nothing changed
+    printf("list: %d bytes, for a %d byte bitmap\n",
+           gfxListUsed(), (int)sizeof(bitmap));
+
+    gfxInit(128, 64, bitmap);
+    start = clock();
+    for(i = 0; i < FRAMES; i++)
+        direct();
+    tDirect = usPerFrame(start);
+
+    start = clock();
+    for(i = 0; i < FRAMES; i++) {
+        direct();
+        lcdWriteBuffer(bitmap);
+    }
+    tSend = usPerFrame(start);
+
+    start = clock();
+    for(i = 0; i < FRAMES; i++) {
+        gfxListInvalidate();
+        gfxListRender();
+    }
+    tList = usPerFrame(start);
+
+    printf("host time per frame: direct %.1f us, %.1f us sent; "
+           "list replay %.1f us, sent\n", tDirect, tSend, tList);
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchList");
+}
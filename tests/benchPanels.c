@@ -0,0 +1,98 @@
+//
+// benchPanels - Two panels on one bus (st7565.c), on the simulated clock
+// with the bus taking time per byte: a frame to each written one after
+// the other (lcdSelect, lcdWriteBuffer) against interleaved
+// (lcdWriteBuffers), where each panel's pauses after a transfer are
+// spent on the other's.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o benchPanels benchPanels.c mock.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "product_config.h"
+#include "mock.h"
+#include "p32_utils.h"
+#include "lcdBus.h"
+#include "st7565.h"
+#include "task.h"
+
+#define BYTE_TICKS 32       // A byte at 10 MHz SPI, in 40 MHz ticks
+
+static lcdPanel_t rear = {
+    .cs = { 0, 0, MOCK_CS2 }, .a0 = { 0, 0, LCD_MOCK_A0 },
+    .res = { 0, 0, LCD_MOCK_RES },
+    .width = 128, .pages = 8,
+    .resistorRatio = 4, .volume = 28, .orientation = LCD_ORIENT_180
+};
+
+static uint8_t front[1024], back[1024];
+
+static double msSince(uint32_t t0)
+{
+    return (mockTicks - t0) / (double)tickFromMs(1);
+}
+
+// True if each glass shows its bitmap (the rear panel upside down)
+static int bothShow(void)
+{
+    int16_t x, y;
+
+    for(y = 0; y < 64; y++)
+        for(x = 0; x < 128; x++)
+            if(mockLcdPixelOf(&mockLcd2, 127 - x, 63 - y) !=
+               ((back[(y / 8) * 128 + x] >> (7 - y % 8)) & 1))
+                return 0;
+    return mockLcdShows(front);
+}
+
+int main(void)
+{
+    lcdPanel_t *const panels[2] = { &lcdPanel0, &rear };
+    const uint8_t *const buffs[2] = { front, back };
+    task_t ta = { 0 }, tb = { 0 };
+    uint8_t doneA = 0, doneB = 0;
+    uint32_t t0;
+    double sequential, interleaved;
+    int i;
+
+    // /RES is shared: bring both up together
+    lcdPanel0.resistorRatio = 5;
+    lcdPanel0.volume = 35;
+    while(!doneA || !doneB) {
+        if(!doneA) doneA = lcdPanelInitTask(&ta, &lcdPanel0, NULL) == TASK_DONE;
+        if(!doneB) doneB = lcdPanelInitTask(&tb, &rear, NULL) == TASK_DONE;
+    }
+    mockTicksPerByte = BYTE_TICKS;
+
+    for(i = 0; i < 1024; i++) {
+        front[i] = i * 13 + 1;
+        back[i] = i * 7 + 3;
+    }
+    t0 = mockTicks;
+    lcdSelect(&lcdPanel0);
+    lcdWriteBuffer(front);
+    lcdSelect(&rear);
+    lcdWriteBuffer(back);
+    lcdSelect(&lcdPanel0);
+    sequential = msSince(t0);
+    CHECK(bothShow());
+
+    for(i = 0; i < 1024; i++) {
+        front[i] = i * 5 + 2;
+        back[i] = i * 11 + 9;
+    }
+    t0 = mockTicks;
+    lcdWriteBuffers(panels, buffs, 2);
+    interleaved = msSince(t0);
+    CHECK(bothShow());
+
+    printf("One after the other: %.2f ms\n", sequential);
+    printf("Interleaved:         %.2f ms\n", interleaved);
+    CHECK(interleaved < sequential);
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchPanels");
+}
@@ -0,0 +1,133 @@
+//
+// benchPoints - Point lists (gfxPlotPoints, gfxPolyline in gfx.c): host
+// time per point in a bitmap, and LCD bus cycles (commands, data and
+// reads) in read-modify-write mode, each against the gfxPixel or gfxLine
+// loop that draws the same; and the spans they report flushing the
+// damage (gfxDamage.c) to the LCD.
+//
+// Build from this directory with:
+//     cc -O2 -I. -I.. -o benchPoints benchPoints.c mock.c ../gfx.c
+//        ../gfxDamage.c ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "gfxDamage.h"
+#include "st7565.h"
+
+#define MAX_POINTS 10000
+#define PLOTS      2000000L     // Points plotted per bitmap timing
+
+static uint8_t bitmapA[1024], bitmapB[1024], ram[9][132];
+static int16_t xy[2 * MAX_POINTS];
+
+static uint32_t busCycles(void)
+{
+    return mockLcd.cmds + mockLcd.data + mockLcd.reads;
+}
+
+static double nsSince(clock_t start, long points)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / points;
+}
+
+int main(void)
+{
+    static const int16_t sizes[3] = { 200, 1000, 10000 };
+    int16_t pts[] = { 5, 3,  100, 3,  50, 40,  60, 41,  -5, 10 };
+    int16_t line[] = { 10, 10,  30, 20,  20, 50 };
+    uint32_t pixel, plot;
+    double a, b;
+    clock_t start;
+    int k, i, n, r, reps;
+
+    lcdInit(5, 35);
+
+    for(k = 0; k < 3; k++)
+    {
+        n = sizes[k];
+        reps = PLOTS / n;
+        srand(n);
+        for(i = 0; i < n; i++) {            // Some off the bitmap
+            xy[2 * i] = rand() % 140 - 6;
+            xy[2 * i + 1] = rand() % 72 - 4;
+        }
+
+        // Bitmap: host time
+        gfxInit(128, 64, bitmapA);
+        start = clock();
+        for(r = 0; r < reps; r++)
+            for(i = 0; i < n; i++)
+                gfxPixel(xy[2 * i], xy[2 * i + 1], (r & 1) ^ 1);
+        a = nsSince(start, (long)reps * n);
+
+        gfxInit(128, 64, bitmapB);
+        start = clock();
+        for(r = 0; r < reps; r++)
+            gfxPlotPoints(n, xy, (r & 1) ^ 1);
+        b = nsSince(start, (long)reps * n);
+        CHECK(!memcmp(bitmapA, bitmapB, sizeof(bitmapA)));
+        printf("%5d points, bitmap:  gfxPixel %5.1f ns/pt, "
+               "gfxPlotPoints %5.1f ns/pt\n", n, a, b);
+
+        // Straight to the LCD: bus cycles
+        gfxInit(128, 64, NULL);
+        memset(mockLcd.ram, 0, sizeof(mockLcd.ram));
+        pixel = busCycles();
+        for(i = 0; i < n; i++)
+            gfxPixel(xy[2 * i], xy[2 * i + 1], 1);
+        pixel = busCycles() - pixel;
+        memcpy(ram, mockLcd.ram, sizeof(ram));
+
+        memset(mockLcd.ram, 0, sizeof(mockLcd.ram));
+        plot = busCycles();
+        gfxPlotPoints(n, xy, 1);
+        plot = busCycles() - plot;
+        CHECK(!memcmp(ram, mockLcd.ram, sizeof(ram)));
+        CHECK(plot < pixel);
+        printf("              RMW:     gfxPixel %7lu cycles, "
+               "gfxPlotPoints %7lu\n", (unsigned long)pixel, (unsigned long)plot);
+
+        // A polyline across the LCD
+        for(i = 0; i < n; i++) {
+            xy[2 * i] = i * 128 / n;
+            xy[2 * i + 1] = 32 + rand() % 40 - 20;
+        }
+        memset(mockLcd.ram, 0, sizeof(mockLcd.ram));
+        pixel = busCycles();
+        for(i = 1; i < n; i++)
+            gfxLine(xy[2 * i - 2], xy[2 * i - 1], xy[2 * i], xy[2 * i + 1], 1);
+        gfxPixel(xy[2 * n - 2], xy[2 * n - 1], 1);  // (gfxLine leaves it out)
+        pixel = busCycles() - pixel;
+        memcpy(ram, mockLcd.ram, sizeof(ram));
+
+        memset(mockLcd.ram, 0, sizeof(mockLcd.ram));
+        plot = busCycles();
+        gfxPolyline(n, xy, 1);
+        plot = busCycles() - plot;
+        CHECK(!memcmp(ram, mockLcd.ram, sizeof(ram)));
+        CHECK(plot < pixel);
+        printf("              RMW:     gfxLine  %7lu cycles, "
+               "gfxPolyline   %7lu\n", (unsigned long)pixel, (unsigned long)plot);
+    }
+
+    // The spans reported, as damage, bring the LCD up to date
+    gfxInit(128, 64, bitmapA);
+    gfxFill(0);
+    lcdWriteBuffer(bitmapA);
+    gfxDamageClear();
+    gfxSetSpanHook(gfxDamageSpan);
+    gfxPlotPoints(5, pts, 1);
+    gfxPolyline(3, line, 1);
+    gfxSetSpanHook(NULL);
+    gfxDamageFlush(bitmapA);
+    CHECK(mockLcdShows(bitmapA));
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchPoints");
+}
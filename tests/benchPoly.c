@@ -0,0 +1,142 @@
+//
+// benchPoly - Polygon fill (gfxFillPoly): random polygons, in a bitmap and
+// without one (RMW), match an even-odd test of each pixel's centre; fills
+// stay inside a viewport; and the host time per fill, against that
+// pixel-at-a-time test.
+//
+// Build from this directory with:
+//     cc -O2 -I. -I.. -o benchPoly benchPoly.c mock.c ../gfx.c
+//        ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "st7565.h"
+
+#define FILLS 20000
+
+static uint8_t bitmap[1024], reference[1024];
+
+// Fill by testing each pixel in the bounding box: inside if an odd number
+// of edges cross the column at or above the pixel
+static void fillByPixel(int n, const int16_t *xy, uint8_t color)
+{
+    int i, j, x, y, in, ax, ay, bx, by, t;
+    int x0 = INT16_MAX, x1 = INT16_MIN, y0 = INT16_MAX, y1 = INT16_MIN;
+
+    for(i = 0; i < n; i++) {
+        if(xy[2*i] < x0) x0 = xy[2*i];
+        if(xy[2*i] > x1) x1 = xy[2*i];
+        if(xy[2*i+1] < y0) y0 = xy[2*i+1];
+        if(xy[2*i+1] > y1) y1 = xy[2*i+1];
+    }
+
+    for(x = x0; x < x1; x++)
+        for(y = y0; y < y1; y++)
+        {
+            for(in = 0, i = 0; i < n; i++)
+            {
+                j = (i + 1) % n;
+                ax = xy[2*i]; ay = xy[2*i+1];
+                bx = xy[2*j]; by = xy[2*j+1];
+                if(ax == bx) continue;
+                if(ax > bx) {
+                    t = ax; ax = bx; bx = t;
+                    t = ay; ay = by; by = t;
+                }
+                if(x < ax || x >= bx) continue;
+                if((long)(y - ay) * (bx - ax) >= (long)(x - ax) * (by - ay))
+                    in ^= 1;
+            }
+            if(in) gfxPixel(x, y, color);
+        }
+}
+
+static double usPerFill(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC / FILLS * 1e6;
+}
+
+int main(void)
+{
+    static int16_t tri[] = { 5, 3, 120, 30, 40, 60 };
+    static int16_t star[] = { 64, 0, 78, 44, 20, 17, 108, 17, 50, 44 };
+    static int16_t needle[] = { 64, 60, 66, 60, 100, 8 };
+    static const struct {
+        const char *name;
+        int n;
+        const int16_t *xy;
+    } shapes[] = {
+        { "triangle", 3, tri }, { "star", 5, star }, { "needle", 3, needle }
+    };
+    int16_t xy[26];
+    clock_t start;
+    double tFill, tPixel;
+    int t, i, n, x, y, same, outside;
+
+    srand(5);
+    lcdInit(5, 35);
+
+    for(same = 1, t = 0; t < 4000; t++)
+    {
+        n = 3 + rand() % 10;
+        for(i = 0; i < n; i++) {
+            xy[2*i] = rand() % 200 - 36;
+            xy[2*i+1] = rand() % 120 - 28;
+            if(t % 3 == 0) {            // Small ones too
+                xy[2*i] = xy[2*i] / 4 + 40;
+                xy[2*i+1] = xy[2*i+1] / 4 + 20;
+            }
+        }
+        gfxInit(128, 64, reference);
+        fillByPixel(n, xy, 1);
+
+        if(t % 2) {
+            gfxInit(128, 64, NULL);
+            gfxFillPoly(n, xy, 1);
+            same &= mockLcdShows(reference);
+        }
+        else {
+            gfxInit(128, 64, bitmap);
+            gfxFillPoly(n, xy, 1);
+            same &= !memcmp(bitmap, reference, sizeof(bitmap));
+        }
+    }
+    CHECK(same);
+
+    gfxInit(128, 64, bitmap);
+    gfxPushViewport(20, 10, 60, 40);
+    gfxFillTriangle(-10, -10, 100, 5, 10, 80, 1);
+    gfxPopClip();
+    for(outside = 0, y = 0; y < 64; y++)
+        for(x = 0; x < 128; x++)
+            if(((bitmap[(y / 8) * 128 + x] >> (7 - y % 8)) & 1) &&
+               (x < 20 || x > 60 || y < 10 || y > 40))
+                outside++;
+    CHECK(outside == 0);
+
+    printf("host time per fill    gfxFillPoly   by pixel\n");
+    for(i = 0; i < 3; i++)
+    {
+        gfxInit(128, 64, bitmap);
+        start = clock();
+        for(t = 0; t < FILLS; t++)
+            gfxFillPoly(shapes[i].n, shapes[i].xy, 1);
+        tFill = usPerFill(start);
+
+        start = clock();
+        for(t = 0; t < FILLS; t++)
+            fillByPixel(shapes[i].n, shapes[i].xy, 1);
+        tPixel = usPerFill(start);
+
+        printf("%-20s %8.2f us %8.2f us\n", shapes[i].name, tFill, tPixel);
+    }
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchPoly");
+}
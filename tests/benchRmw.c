@@ -0,0 +1,60 @@
+//
+// benchRmw - Drawing without a bitmap (gfx.c's read-modify-write mode)
+// against drawing in a bitmap and sending all of it: LCD bus cycles
+// (commands, data writes and reads) per primitive, on the mock LCD, with
+// a check that both leave the glass showing the same.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o benchRmw benchRmw.c mock.c ../gfx.c ../gfxFont.c
+//        ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "st7565.h"
+
+static uint8_t bitmap[1024];
+
+static uint32_t busCycles(void)
+{
+    return mockLcd.cmds + mockLcd.data + mockLcd.reads;
+}
+
+// Draw with "call" both ways, and print the cycles each took
+#define BOTH(name, call) do {                                          \
+        uint32_t b0, full, rmw;                                        \
+        gfxInit(128, 64, bitmap);                                      \
+        call;                                                          \
+        b0 = busCycles();                                              \
+        lcdWriteBuffer(bitmap);                                        \
+        full = busCycles() - b0;                                       \
+        gfxInit(128, 64, NULL);                                        \
+        b0 = busCycles();                                              \
+        call;                                                          \
+        rmw = busCycles() - b0;                                        \
+        CHECK(mockLcdShows(bitmap));                                   \
+        CHECK(rmw < full);                                             \
+        printf("%-12s %6lu %6lu\n", name,                              \
+               (unsigned long)full, (unsigned long)rmw);               \
+    } while(0)
+
+int main(void)
+{
+    lcdInit(5, 35);
+
+    printf("bus cycles   bitmap    RMW\n");
+    BOTH("pixel", gfxPixel(10, 20, 1));
+    BOTH("hline", gfxLine(0, 5, 127, 5, 1));
+    BOTH("diagonal", gfxLine(0, 0, 127, 63, 1));
+    BOTH("rect 20x20", gfxRect(10, 10, 30, 30, 1));
+    BOTH("frect 20x20", gfxFRect(10, 10, 30, 30, 1));
+    BOTH("circle r20", gfxCircle(64, 32, 20, 1));
+    BOTH("fcircle r20", gfxFCircle(64, 32, 20, 1));
+    BOTH("string", gfxString(0, 2, "Hello world"));
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchRmw");
+}
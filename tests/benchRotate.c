@@ -0,0 +1,107 @@
+//
+// benchRotate - Sending a bitmap in each orientation (st7565.c): the glass
+// shows it turned the right way, and the host time per frame in portrait
+// (pages transposed 8x8 bytes at a time, as lcdWriteBuffer does) against
+// landscape, and against rotating a bit at a time first.
+//
+// Build from this directory with:
+//     cc -O2 -I. -I.. -o benchRotate benchRotate.c mock.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "st7565.h"
+
+#define FRAMES 20000
+
+static uint8_t bitmap[1024], landscape[1024];
+
+// Pixel lx,ly of a bitmap w pixels wide
+static uint8_t pixel(const uint8_t *b, int16_t lx, int16_t ly, int16_t w)
+{
+    return (b[(ly / 8) * w + lx] >> (7 - ly % 8)) & 1;
+}
+
+// What the glass should show at x,y in orientation o
+static uint8_t expected(uint8_t o, int16_t x, int16_t y)
+{
+    switch(o)
+    {
+    case LCD_ORIENT_0:   return pixel(bitmap, x, y, 128);
+    case LCD_ORIENT_180: return pixel(bitmap, 127 - x, 63 - y, 128);
+    case LCD_ORIENT_90:  return pixel(bitmap, y, 127 - x, 64);
+    default:             return pixel(bitmap, 63 - y, x, 64);
+    }
+}
+
+// The portrait bitmap turned to landscape a pixel at a time (for 90)
+static void rotateByBit(void)
+{
+    int16_t x, y;
+
+    memset(landscape, 0, sizeof(landscape));
+    for(y = 0; y < 64; y++)
+        for(x = 0; x < 128; x++)
+            if(expected(LCD_ORIENT_90, x, y))
+                landscape[(y / 8) * 128 + x] |= 0x80 >> (y % 8);
+}
+
+static double usPerFrame(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC / FRAMES * 1e6;
+}
+
+int main(void)
+{
+    clock_t start;
+    double t0, t90, tBit;
+    int16_t x, y;
+    uint8_t o;
+    int i, ok;
+
+    srand(3);
+    lcdInit(5, 35);
+
+    for(o = LCD_ORIENT_0; o <= LCD_ORIENT_270; o++)
+    {
+        for(i = 0; i < 1024; i++)
+            bitmap[i] = rand();
+        lcdSetOrientation(o);
+        lcdWriteBuffer(bitmap);
+        for(ok = 1, y = 0; y < 64; y++)
+            for(x = 0; x < 128; x++)
+                ok &= mockLcdPixel(x, y) == expected(o, x, y);
+        CHECK(ok);
+    }
+
+    lcdSetOrientation(LCD_ORIENT_0);
+    start = clock();
+    for(i = 0; i < FRAMES; i++)
+        lcdWriteBuffer(bitmap);
+    t0 = usPerFrame(start);
+
+    lcdSetOrientation(LCD_ORIENT_90);
+    start = clock();
+    for(i = 0; i < FRAMES; i++)
+        lcdWriteBuffer(bitmap);
+    t90 = usPerFrame(start);
+
+    lcdSetOrientation(LCD_ORIENT_0);
+    start = clock();
+    for(i = 0; i < FRAMES; i++) {
+        rotateByBit();
+        lcdWriteBuffer(landscape);
+    }
+    tBit = usPerFrame(start);
+    CHECK(mockLcdShows(landscape));
+
+    printf("host time per frame: landscape %.1f us, portrait %.1f us; "
+           "rotated a bit at a time %.1f us\n", t0, t90, tBit);
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchRotate");
+}
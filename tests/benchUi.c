@@ -0,0 +1,68 @@
+//
+// benchUi - Retained-mode widgets (ui.c): LCD bytes sent per change, for
+// a readout, an unchanged value, a gauge and a button press, against the
+// 1024 of sending the whole bitmap; and that the glass keeps up.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o benchUi benchUi.c mock.c ../ui.c ../gfx.c
+//        ../gfxDamage.c ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "ui.h"
+#include "st7565.h"
+
+static uint8_t bitmap[1024];
+
+// uiRedraw, printing and checking the display data bytes it sent
+static uint16_t redraw(const char *what)
+{
+    uint32_t d0 = mockLcd.data;
+    uint16_t n = uiRedraw();
+
+    CHECK(n == mockLcd.data - d0);
+    CHECK(mockLcdShows(bitmap));
+    printf("%-16s %5u bytes\n", what, n);
+    return n;
+}
+
+int main(void)
+{
+    int8_t readout, gauge, button, box;
+
+    lcdInit(5, 35);
+    gfxInit(128, 64, bitmap);
+    uiInit(bitmap);
+
+    uiLabel(0, 0, "Temp");
+    readout = uiReadout(40, 0, 7, 1);
+    gauge = uiGauge(0, 16, 128, 10, 0, 100);
+    button = uiButton(0, 40, 50, 20, "OK");
+    box = uiCheckbox(60, 5, "Fan");
+
+    CHECK(redraw("first frame") == 1024);
+
+    uiSetValue(readout, -235);
+    CHECK(redraw("readout") < 64);
+    uiSetValue(readout, -235);
+    CHECK(redraw("unchanged") == 0);
+    uiSetValue(gauge, 50);
+    CHECK(redraw("gauge") <= 256);
+
+    CHECK(uiTouch(10, 50, true) == -1);
+    CHECK(redraw("button down") <= 192);
+    CHECK(uiTouch(10, 50, false) == button);
+    redraw("button up");
+
+    CHECK(uiTouch(62, 44, true) == box);
+    CHECK(uiGetValue(box) == 1);
+    uiTouch(0, 0, false);
+    redraw("checkbox");
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("benchUi");
+}
@@ -0,0 +1,279 @@
+//
+// mock.c - Models of the clock, ST7565 and TSC2046 for the host tests
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "product_config.h"
+#include "mock.h"
+#include "p32_utils.h"
+#include "lcdBus.h"
+#include "st7565.h"
+
+#define TICKS_PER_US 40     // CP0 Count at 80 MHz
+
+uint32_t  mockTicks;
+uint32_t  mockTicksPerByte;
+mockLcd_t mockLcd = { .cs = 1, .res = 1 };
+mockLcd_t mockLcd2 = { .cs = 1, .res = 1 };
+mockTsc_t mockTsc;
+
+static int checks, failures;
+
+
+//
+// Clock
+//
+uint32_t tickNow(void)
+{
+    return mockTicks++;
+}
+
+uint32_t tickFromUs(uint32_t usec)
+{
+    return usec * TICKS_PER_US;
+}
+
+uint32_t tickFromMs(uint32_t msec)
+{
+    return msec * TICKS_PER_US * 1000;
+}
+
+void mockAdvanceUs(uint32_t us)
+{
+    mockTicks += tickFromUs(us);
+}
+
+void delay_us(uint32_t usec)
+{
+    mockAdvanceUs(usec);
+}
+
+void delay_ms(uint32_t msec)
+{
+    mockTicks += tickFromMs(msec);
+}
+
+
+//
+// ST7565
+//
+static void lcdReset(mockLcd_t *m)
+{
+    m->page = 0;
+    m->col = 0;
+    m->startLine = 0;
+    m->adcReverse = 0;
+    m->comReverse = 0;
+    m->on = 0;
+    m->rmw = 0;
+    m->arg = 0;
+}
+
+static void lcdCommand(mockLcd_t *m, uint8_t c)
+{
+    if(m->arg) {                            // (Its value isn't modelled)
+        m->arg = 0;
+        return;
+    }
+
+    if(c == cVOLUME || c == cBOOSTRATIO || c == cSLEEP_ENTER || c == cSLEEP_EXIT)
+        m->arg = 1;
+    else if((c & 0xF0) == cPAGE)
+        m->page = c & 0x0F;
+    else if((c & 0xF0) == cCOL_MS)
+        m->col = (m->col & 0x0F) | ((c & 0x0F) << 4);
+    else if((c & 0xF0) == cCOL_LS)
+        m->col = (m->col & 0xF0) | (c & 0x0F);
+    else if((c & 0xC0) == cDISP_START_LINE)
+        m->startLine = c & 0x3F;
+    else if(c == cADC_NORMAL || c == cADC_REVERSE)
+        m->adcReverse = c & 1;
+    else if(c == cCOM_NORMAL || c == cCOM_REVERSE)
+        m->comReverse = (c == cCOM_REVERSE);
+    else if(c == cDISPLAY_ON || c == cDISPLAY_OFF)
+        m->on = (c == cDISPLAY_ON);
+    else if(c == cRMW_BEGIN) {
+        m->rmw = 1;
+        m->rmwCol = m->col;
+    }
+    else if(c == cRMW_END) {
+        m->rmw = 0;
+        m->col = m->rmwCol;
+    }
+    else if(c == cRESET) {
+        m->page = 0;
+        m->col = 0;
+        m->startLine = 0;
+    }
+}
+
+// The controller a transfer goes to: the one selected, if it's alone and
+// not in reset. NULL (and an error) otherwise.
+static mockLcd_t *lcdSelected(void)
+{
+    mockLcd_t *m = !mockLcd.cs ? &mockLcd : &mockLcd2;
+
+    mockTicks += mockTicksPerByte;
+    if(m->cs || !m->res || (!mockLcd.cs && !mockLcd2.cs)) {
+        mockLcd.errors++;
+        return NULL;
+    }
+    return m;
+}
+
+void lcdMockPin(const lcdPin_t *pin, uint8_t level)
+{
+    switch(pin->bit)
+    {
+    case LCD_MOCK_CS:  mockLcd.cs = level;  break;
+    case MOCK_CS2:     mockLcd2.cs = level;  break;
+    case LCD_MOCK_A0:  mockLcd.a0 = mockLcd2.a0 = level;  break;
+    case LCD_MOCK_RES:
+        if(!level) {
+            lcdReset(&mockLcd);
+            lcdReset(&mockLcd2);
+        }
+        mockLcd.res = mockLcd2.res = level;
+        break;
+    }
+}
+
+void lcdMockDir(uint8_t input)
+{
+    (void)input;
+}
+
+void lcdMockDelayUs(uint32_t us)
+{
+    mockAdvanceUs(us);
+}
+
+void lcdMockWrite(const lcdPanel_t *p, uint8_t data)
+{
+    mockLcd_t *m = lcdSelected();
+
+    (void)p;
+    if(!m) return;
+
+    if(!m->a0) {
+        m->cmds++;
+        lcdCommand(m, data);
+        return;
+    }
+
+    // Display data: writes advance the column, in RMW mode too
+    m->data++;
+    if(m->page < 9 && m->col < 132)
+        m->ram[m->page][m->col] = data;
+    if(m->col < 131)
+        m->col++;
+}
+
+uint8_t lcdMockRead(const lcdPanel_t *p)
+{
+    mockLcd_t *m = lcdSelected();
+    uint8_t d;
+
+    (void)p;
+    if(!m) return 0;
+    m->reads++;
+
+    if(!m->a0)                              // Status
+        return (m->on ? 0 : sOFF) | (m->adcReverse ? 0 : sADC);
+
+    // Display data comes through a latch, a read behind: hence the dummy
+    // read after setting the address. Reads don't advance in RMW mode.
+    d = m->latch;
+    if(m->page < 9 && m->col < 132)
+        m->latch = m->ram[m->page][m->col];
+    if(!m->rmw && m->col < 131)
+        m->col++;
+    return d;
+}
+
+uint8_t mockLcdPixelOf(const mockLcd_t *m, int16_t x, int16_t y)
+{
+    uint8_t line, col;
+
+    if(m->comReverse) line = (m->startLine + y) % 64;
+    else              line = (m->startLine + 63 - y) % 64;
+    col = m->adcReverse ? 131 - x : x;
+
+    return (m->ram[line / 8][col] >> (line % 8)) & 1;
+}
+
+uint8_t mockLcdPixel(int16_t x, int16_t y)
+{
+    return mockLcdPixelOf(&mockLcd, x, y);
+}
+
+uint8_t mockLcdShows(const uint8_t *buff)
+{
+    int16_t x, y;
+
+    for(y = 0; y < 64; y++)
+        for(x = 0; x < 128; x++)
+            if(mockLcdPixel(x, y) != ((buff[(y / 8) * 128 + x] >> (7 - y % 8)) & 1))
+                return 0;
+    return 1;
+}
+
+
+//
+// TSC2046
+//
+void tscMockSelect(uint8_t on)
+{
+    mockTsc.selected = on;
+}
+
+void tscMockWrite(uint8_t data)
+{
+    uint8_t ch = (data >> 4) & 7;
+    uint16_t code = mockTsc.code[ch];
+
+    if(!mockTsc.selected) {
+        mockTsc.errors++;
+        return;
+    }
+
+    if(ch == 3 && !mockTsc.touching)        // Z1: no touch, no pressure
+        code = 0;
+    mockTsc.conversions[ch]++;
+    mockTsc.out = (code & 0x0FFF) << 4;     // 12 bits, MS bit first
+}
+
+uint16_t tscMockRead16(void)
+{
+    if(!mockTsc.selected) {
+        mockTsc.errors++;
+        return 0;
+    }
+    return mockTsc.out;
+}
+
+void tscMockDelayUs(uint32_t us)
+{
+    mockAdvanceUs(us);
+}
+
+
+//
+// Checks
+//
+void mockCheck(int ok, const char *what, const char *file, int line)
+{
+    checks++;
+    if(ok) return;
+
+    if(++failures <= 20)
+        printf("%s:%d: FAILED: %s\n", file, line, what);
+}
+
+int mockDone(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+#ifndef __MOCK_H_
+#define __MOCK_H_
+
+#include <stdint.h>
+
+//
+// Host test support
+//
+// The drivers built for a PC (LCD_MOCK, TSC_MOCK; see lcdBus.h and
+// tscBus.h), talking to models of the parts, on a simulated clock:
+//
+//   Clock  - tickNow() etc. at the target's 40 ticks per us. It moves on
+//            only when told to (mockAdvanceUs), through the delays the
+//            drivers ask for, and by a tick per tickNow() read, so busy
+//            waits still end.
+//   ST7565 - Display RAM, the address counters and the modes that decide
+//            what the glass shows (start line, ADC, COM), with reads as
+//            the part does them (a dummy read after setting the address).
+//            A second one (mockLcd2) answers to its own /CS line,
+//            MOCK_CS2, sharing A0 and /RES, for tests of several panels.
+//   TSC2046 - A code for each channel, set by the test; Z1 reads 0 unless
+//            touching.
+//
+// Each test is a program of its own; build from this directory, e.g.:
+//     cc -I. -I.. -o testSprite testSprite.c mock.c ../gfxSprite.c
+//        ../gfxDamage.c ../st7565.c
+// and run it: it prints what failed, and exits non-zero if anything did.
+// The bench*.c programs are built the same way; they print measurements
+// (bus cycles, bytes, simulated or host time) as well.
+//
+
+// Clock
+extern uint32_t mockTicks;
+extern uint32_t mockTicksPerByte;   // Bus time per byte sent or read
+                                    // (0, unless a test sets it)
+
+void mockAdvanceUs(uint32_t us);
+
+// ST7565
+typedef struct {
+    uint8_t  ram[9][132];   // Display RAM: page, column
+    uint8_t  page;
+    uint8_t  col;
+    uint8_t  startLine;
+    uint8_t  adcReverse;
+    uint8_t  comReverse;
+    uint8_t  on;            // Display on
+    uint8_t  rmw;           // In read-modify-write mode
+    uint8_t  rmwCol;        //   ...entered at this column
+    uint8_t  latch;         // Read pipeline (what the next read returns)
+    uint8_t  arg;           // Second byte of a two-byte command due
+    uint8_t  cs, a0, res;   // Line levels
+    uint32_t cmds;          // Bytes written: commands...
+    uint32_t data;          //   ...and display data
+    uint32_t reads;         // Bytes read (status or display data)
+    uint32_t errors;        // Transfers with /CS high, or /RES low
+} mockLcd_t;
+
+extern mockLcd_t mockLcd, mockLcd2;
+
+#define MOCK_CS2 0x08       // lcdPin_t bit of mockLcd2's /CS
+
+// The pixel the glass shows at x,y (landscape, 128x64): 1 if lit
+uint8_t mockLcdPixel(int16_t x, int16_t y);
+uint8_t mockLcdPixelOf(const mockLcd_t *lcd, int16_t x, int16_t y);
+
+// True if the glass shows the 128x64 page-format bitmap buff
+uint8_t mockLcdShows(const uint8_t *buff);
+
+// TSC2046
+typedef struct {
+    uint16_t code[8];       // Conversion result per channel (A2..A0)
+    uint8_t  touching;      // Z1 reads code[3] if set, else 0
+    uint8_t  selected;
+    uint16_t out;           // Result to be clocked out
+    uint32_t conversions[8];
+    uint32_t errors;        // Transfers while not selected
+} mockTsc_t;
+
+extern mockTsc_t mockTsc;
+
+// Checks
+#define CHECK(cond) mockCheck((cond), #cond, __FILE__, __LINE__)
+
+void mockCheck(int ok, const char *what, const char *file, int line);
+
+// Print the tally; the exit status for main()
+int  mockDone(const char *name);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef __PRODUCT_CONFIG_H_
+#define __PRODUCT_CONFIG_H_
+
+//
+// Host test build (see mock.h): no hardware, the LCD and TSC transports
+// go to the models in mock.c.
+//
+
+#include <stdio.h>
+
+#define LCD_MOCK
+#define TSC_MOCK
+
+#define DBPUTS(s) fputs(s, stdout)
+
+#endif
@@ -0,0 +1,100 @@
+//
+// testChart - The strip chart (chart.c), through the mock LCD: each sample
+// costs a few columns of LCD bytes, far fewer than redrawing the trace and
+// sending the whole bitmap, and what the glass shows is the same as a
+// redraw from the ring, with spikes kept when columns are decimated.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o testChart testChart.c mock.c ../chart.c ../gfx.c
+//        ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mock.h"
+#include "chart.h"
+#include "gfx.h"
+#include "st7565.h"
+
+#define SAMPLES 1000
+
+static uint8_t bitmap[1024];
+static int16_t history[128];
+static chartCol_t ring[128];
+static uint8_t shown[9][132];
+
+// A test signal: ramps, steps and the odd spike, in -100..100
+static int16_t signal(int i)
+{
+    int16_t v = (i * 37) % 200 - 100;
+
+    if(i % 53 == 0) v = 100;
+    return i % 64 < 32 ? v / 4 : 60 - (i % 7) * 10;
+}
+
+static uint32_t lcdBytes(void)
+{
+    return mockLcd.cmds + mockLcd.data;
+}
+
+int main(void)
+{
+    chart_t c;
+    uint32_t before, full, swept;
+    int i, x, y, lit;
+
+    lcdInit(5, 35);
+
+    // Baseline: the trace redrawn in a bitmap, and all of it sent, per sample
+    gfxInit(128, 64, bitmap);
+    before = lcdBytes();
+    for(i = 0; i < SAMPLES; i++)
+    {
+        memmove(history, history + 1, 127 * sizeof(history[0]));
+        history[127] = signal(i);
+        gfxFill(0);
+        for(x = 1; x < 128; x++)
+            gfxLine(x - 1, 32 - history[x - 1] / 4, x, 32 - history[x] / 4, 1);
+        lcdWriteBuffer(bitmap);
+    }
+    full = lcdBytes() - before;
+
+    chartInit(&c, ring, 0, 128, 0, 8, -100, 100, 1);
+    before = lcdBytes();
+    for(i = 0; i < SAMPLES; i++)
+        chartAdd(&c, signal(i));
+    swept = lcdBytes() - before;
+
+    printf("LCD bytes per sample: %lu full redraw, %lu chart\n",
+           (unsigned long)(full / SAMPLES), (unsigned long)(swept / SAMPLES));
+    CHECK(swept * 20 < full);
+    CHECK(swept / SAMPLES <= 8 * (3 + 3));  // 3 columns and an address a page
+
+    // The sweep front is blank, the columns either side aren't
+    for(lit = 0, y = 0; y < 64; y++)
+        lit |= mockLcdPixel(c.head, y);
+    CHECK(!lit);
+    for(lit = 0, y = 0; y < 64; y++)
+        lit |= mockLcdPixel((c.head + 127) % 128, y) & mockLcdPixel((c.head + 1) % 128, y);
+    CHECK(lit);
+
+    // Drawn a column at a time, it's the same as drawn all at once
+    memcpy(shown, mockLcd.ram, sizeof(shown));
+    chartRedraw(&c);
+    CHECK(!memcmp(shown, mockLcd.ram, sizeof(shown)));
+
+    // Decimated, in part of the screen: a one-sample spike still shows
+    chartInit(&c, ring, 4, 100, 2, 4, -100, 100, 10);
+    for(i = 0; i < SAMPLES; i++)
+        chartAdd(&c, i == 505 ? 100 : 0);
+    CHECK(ring[50].max == 100);
+    CHECK(mockLcdPixel(4 + 50, 16));        // The top row of the chart
+    CHECK(!mockLcdPixel(4 + 49, 16));
+    memcpy(shown, mockLcd.ram, sizeof(shown));
+    chartRedraw(&c);
+    CHECK(!memcmp(shown, mockLcd.ram, sizeof(shown)));
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("testChart");
+}
@@ -0,0 +1,192 @@
+//
+// testFrame - The frame scheduler (gfxFrame.c) on the simulated clock:
+// bursty updates cost fewer bus bytes than flushing after each change,
+// flushes are paced a frame interval apart, frames keep to their byte
+// budget with the longest-waiting pages first, and deadlines are met.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o testFrame testFrame.c mock.c ../gfxFrame.c
+//        ../gfxDamage.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock.h"
+#include "gfxDamage.h"
+#include "gfxFrame.h"
+#include "p32_utils.h"
+#include "st7565.h"
+#include "task.h"
+
+#define TURN_US 100         // Main loop time per turn
+
+static uint8_t bitmap[1024];
+static task_t t;
+
+// Invert a w x h rectangle of the bitmap
+static void change(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    int16_t i, j;
+
+    for(j = y; j < y + h; j++)
+        for(i = x; i < x + w; i++)
+            bitmap[(j / 8) * 128 + i] ^= 0x80 >> (j % 8);
+}
+
+// True if the LCD shows page "page" of the bitmap
+static uint8_t pageShown(int16_t page)
+{
+    int16_t x, y;
+
+    for(y = page * 8; y < page * 8 + 8; y++)
+        for(x = 0; x < 128; x++)
+            if(mockLcdPixel(x, y) != ((bitmap[page * 128 + x] >> (7 - y % 8)) & 1))
+                return 0;
+    return 1;
+}
+
+// A main loop turn: the scheduler, then the rest of the loop. Returns the
+// bytes sent.
+static uint32_t turn(void)
+{
+    uint32_t before = mockLcd.data;
+
+    gfxFrameTask(&t);
+    mockAdvanceUs(TURN_US);
+    return mockLcd.data - before;
+}
+
+static void restart(uint16_t intervalMs, uint16_t maxBytes)
+{
+    TASK_INIT(&t);
+    gfxDamageClear();
+    gfxFrameInit(bitmap, intervalMs, maxBytes);
+}
+
+int main(void)
+{
+    uint32_t direct, scheduled, sent, frameBytes;
+    uint32_t last, minGap, flushes, t0, frameAt;
+    int16_t i, k, x, y, page, next;
+    uint8_t order[8];
+
+    lcdInit(5, 35);
+    lcdWriteBuffer(bitmap);
+
+    // Bursty load: flushing after each change, then through the scheduler
+    srand(1);
+    t0 = mockLcd.data;
+    for(i = 0; i < 1000; i++)
+        if(rand() % 4 == 0)
+            for(k = 0; k < 6; k++) {
+                x = rand() % 100;
+                y = rand() % 50;
+                change(x, y, 20, 8);
+                gfxDamageRect(x, y, x + 19, y + 7);
+                gfxDamageFlush(bitmap);
+            }
+    direct = mockLcd.data - t0;
+    CHECK(mockLcdShows(bitmap));
+
+    srand(1);
+    restart(20, 0);
+    t0 = mockLcd.data;
+    for(i = 0; i < 1000; i++)                   // A millisecond each
+    {
+        if(rand() % 4 == 0)
+            for(k = 0; k < 6; k++) {
+                x = rand() % 100;
+                y = rand() % 50;
+                change(x, y, 20, 8);
+                gfxFrameInvalidate(x, y, x + 19, y + 7);
+            }
+        for(k = 0; k < 1000 / TURN_US; k++)
+            turn();
+    }
+    for(k = 0; k < 200; k++)
+        turn();
+    scheduled = mockLcd.data - t0;
+    CHECK(mockLcdShows(bitmap));
+    CHECK(scheduled < direct * 3 / 4);
+    printf("bursty load: %u bytes flushing each change, %u scheduled\n",
+           (unsigned)direct, (unsigned)scheduled);
+
+    // Pacing: a change every millisecond, a flush every frame at most
+    restart(20, 0);
+    flushes = 0;
+    last = 0;
+    minGap = ~0u;
+    for(i = 0; i < 200; i++)
+    {
+        change(0, 0, 10, 8);
+        gfxFrameInvalidate(0, 0, 9, 7);
+        for(k = 0; k < 1000 / TURN_US; k++)
+            if(turn()) {
+                if(flushes && mockTicks - last < minGap)
+                    minGap = mockTicks - last;
+                last = mockTicks;
+                flushes++;
+            }
+    }
+    CHECK(flushes >= 9 && flushes <= 11);
+    CHECK(minGap >= tickFromMs(20));
+
+    // Budget: 256 bytes a frame, longest-waiting pages first
+    restart(20, 256);
+    for(page = 0; page < 8; page++) {
+        change(0, page * 8, 128, 8);
+        gfxFrameInvalidate(0, page * 8, 127, page * 8 + 7);
+        mockAdvanceUs(1000);
+    }
+    next = 0;
+    frameBytes = 0;
+    frameAt = mockTicks;
+    for(k = 0; k < 2000; k++)
+    {
+        if(!(sent = turn())) continue;
+        if(mockTicks - frameAt > tickFromMs(10)) {  // A new frame
+            CHECK(mockTicks - frameAt >= tickFromMs(20));
+            frameAt = mockTicks;
+            frameBytes = 0;
+        }
+        frameBytes += sent;
+        CHECK(frameBytes <= 256);
+        for(page = 0; page < 8; page++)
+            if(pageShown(page) && memchr(order, page, next) == NULL && next < 8)
+                order[next++] = page;
+    }
+    CHECK(next == 8);
+    for(page = 0; page < next; page++)
+        CHECK(order[page] == page);
+    CHECK(mockLcdShows(bitmap));
+
+    // Deadlines: page 3 within 5 ms, between frames; page 5 waits
+    restart(100, 0);
+    change(0, 0, 5, 8);
+    gfxFrameInvalidate(0, 0, 4, 7);
+    for(k = 0; k < 200; k++)                    // (That frame goes)
+        turn();
+    change(0, 24, 5, 8);
+    gfxFrameInvalidateBy(0, 24, 4, 31, 5);
+    change(0, 40, 5, 8);
+    gfxFrameInvalidate(0, 40, 4, 47);
+    t0 = mockTicks;
+    while(!pageShown(3) && mockTicks - t0 < tickFromMs(200))
+        turn();
+    CHECK(mockTicks - t0 <= tickFromMs(6));     // (A turn, and the transfer)
+    CHECK(!pageShown(5));
+    while(!pageShown(5) && mockTicks - t0 < tickFromMs(200))
+        turn();
+    CHECK(pageShown(5));
+    CHECK(mockTicks - t0 >= tickFromMs(60));    // (The frame, 100 ms on)
+
+    // Deadline 0: sent there and then
+    change(0, 56, 5, 8);
+    gfxFrameInvalidateBy(0, 56, 4, 63, 0);
+    CHECK(pageShown(7));
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("testFrame");
+}
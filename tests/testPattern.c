@@ -0,0 +1,136 @@
+//
+// testPattern - Pattern fills (gfxPatFRect, gfxPatFillPoly, gfxPatFCircle)
+// keep the tile's phase: whatever the viewport, pattern origin and colour,
+// and drawn in a bitmap or straight to the LCD (no bitmap), each pixel is
+// the tile's pixel at its offset from the origin.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o testPattern testPattern.c mock.c ../gfx.c
+//        ../gfxPattern.c ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "gfxPattern.h"
+#include "st7565.h"
+
+#define TILES (sizeof(tiles) / sizeof(tiles[0]))
+
+static const uint8_t *const tiles[] = {
+    gfxPatGray12, gfxPatGray25, gfxPatGray50, gfxPatGray75, gfxPatGray88,
+    gfxPatHatchH, gfxPatHatchV, gfxPatHatchDown, gfxPatHatchUp,
+    gfxPatCross, gfxPatDiagCross, gfxPatDots
+};
+
+static uint8_t bitmap[1024], solid[1024];
+
+static uint8_t bitmapPixel(const uint8_t *b, int16_t x, int16_t y)
+{
+    return (b[(y / 8) * 128 + x] >> (7 - y % 8)) & 1;
+}
+
+// The tile's pixel at column c, row r (tiles repeat every 8)
+static uint8_t tilePixel(const uint8_t *tile, int16_t c, int16_t r)
+{
+    return (tile[c & 7] >> (7 - (r & 7))) & 1;
+}
+
+int main(void)
+{
+    int t, x, y, ok;
+    int ax, ay, vx, vy, x0, y0, x1, y1, r, cx, cy;
+    uint8_t toLcd, poly, color, bg, in, want, got;
+    const uint8_t *tile;
+    int16_t xy[8];
+
+    srand(9);
+    lcdInit(5, 35);
+
+    // Rectangles and polygons, in a viewport, against the tile
+    for(t = 0; t < 6000; t++)
+    {
+        tile = tiles[t % TILES];
+        ax = rand() % 40 - 20;
+        ay = rand() % 40 - 20;
+        toLcd = rand() % 3 == 1;
+        poly = !toLcd && rand() % 2;
+        color = rand() % 3;
+        bg = rand() % 2;
+        vx = rand() % 20;
+        vy = rand() % 20;
+        x0 = rand() % 110;
+        y0 = rand() % 60;
+        x1 = x0 + rand() % 40;
+        y1 = y0 + rand() % 30;
+
+        if(toLcd) {
+            gfxInit(128, 64, NULL);
+            memset(mockLcd.ram, bg ? 0xFF : 0, sizeof(mockLcd.ram));
+        }
+        else {
+            gfxInit(128, 64, bitmap);
+            gfxFill(bg ? 0xFF : 0);
+        }
+
+        gfxPushViewport(vx, vy, 127, 63);
+        gfxPatternOrigin(ax, ay);
+        if(poly) {
+            // Same area as the rectangle: a polygon leaves out its right
+            // and bottom edges
+            xy[0] = x0 - vx;  xy[1] = y0 - vy;
+            xy[2] = x1 - vx;  xy[3] = y0 - vy;
+            xy[4] = x1 - vx;  xy[5] = y1 - vy;
+            xy[6] = x0 - vx;  xy[7] = y1 - vy;
+            gfxPatFillPoly(4, xy, tile, color);
+            x1--;
+            y1--;
+        }
+        else
+            gfxPatFRect(x0 - vx, y0 - vy, x1 - vx, y1 - vy, tile, color);
+        gfxPopClip();
+
+        for(ok = 1, y = 0; y < 64 && ok; y++)
+            for(x = 0; x < 128 && ok; x++)
+            {
+                in = x >= x0 && x <= x1 && y >= y0 && y <= y1 &&
+                     x >= vx && y >= vy;
+                want = bg;
+                if(in) {
+                    if(color == GFX_PAT_OPAQUE)
+                        want = tilePixel(tile, x - vx - ax, y - vy - ay);
+                    else if(tilePixel(tile, x - vx - ax, y - vy - ay))
+                        want = color;
+                }
+                got = toLcd ? mockLcdPixel(x, y) : bitmapPixel(bitmap, x, y);
+                ok = got == want;
+            }
+        CHECK(ok);
+    }
+
+    // Circles: the solid circle's pixels, through the tile
+    for(t = 0; t < 2000; t++)
+    {
+        tile = tiles[t % TILES];
+        cx = rand() % 128;
+        cy = rand() % 64;
+        r = rand() % 30;
+
+        gfxInit(128, 64, solid);
+        gfxFCircle(cx, cy, r, 1);
+        gfxInit(128, 64, bitmap);
+        gfxPatFCircle(cx, cy, r, tile, 1);
+
+        for(ok = 1, y = 0; y < 64 && ok; y++)
+            for(x = 0; x < 128 && ok; x++)
+                ok = bitmapPixel(bitmap, x, y) ==
+                     (bitmapPixel(solid, x, y) & tilePixel(tile, x, y));
+        CHECK(ok);
+    }
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("testPattern");
+}
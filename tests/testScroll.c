@@ -0,0 +1,157 @@
+//
+// testScroll - gfxScrollRegion against a pixel-by-pixel reference, over
+// random rectangles, distances, fills and clips: bit-exact, with exactly
+// the spans changed reported. Then times a few scroll distances.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o testScroll testScroll.c mock.c ../gfx.c
+//        ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock.h"
+#include "gfx.h"
+
+static uint8_t bitmap[1024], ref[1024], old[1024];
+static int16_t spans[8][2];     // Per page: col0, col1 reported (-1: none)
+
+static uint8_t getPixel(const uint8_t *b, int16_t x, int16_t y)
+{
+    return (b[(y / 8) * 128 + x] >> (7 - y % 8)) & 1;
+}
+
+static void setPixel(uint8_t *b, int16_t x, int16_t y, uint8_t v)
+{
+    uint8_t m = 0x80 >> (y % 8);
+
+    if(v) b[(y / 8) * 128 + x] |= m;
+    else  b[(y / 8) * 128 + x] &= ~m;
+}
+
+static void spanHook(int16_t page, int16_t col0, int16_t col1)
+{
+    spans[page][0] = col0;
+    spans[page][1] = col1;
+}
+
+static void randomize(void)
+{
+    int i;
+
+    for(i = 0; i < 1024; i++)
+        bitmap[i] = rand();
+}
+
+// Microseconds per full-screen scroll by dx,dy
+static double timeScroll(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         int16_t dx, int16_t dy)
+{
+    clock_t c0 = clock();
+    int i, n = 20000;
+
+    for(i = 0; i < n; i++)
+        gfxScrollRegion(x0, y0, x1, y1, dx, dy, 0);
+    return (double)(clock() - c0) / CLOCKS_PER_SEC / n * 1e6;
+}
+
+int main(void)
+{
+    static const int16_t dists[] = { 1, 3, 8, 13, 24 };
+    int it, x, y, p, sx, sy, ok, want;
+    int x0, y0, x1, y1, dx, dy, cx0, cy0, cx1, cy1;
+    int a, b, c, d;
+    uint8_t fill, clip;
+
+    srand(3);
+    gfxInit(128, 64, bitmap);
+    gfxSetSpanHook(spanHook);
+
+    for(it = 0; it < 50000; it++)
+    {
+        randomize();
+        x0 = rand() % 140 - 6;
+        x1 = rand() % 140 - 6;
+        y0 = rand() % 76 - 6;
+        y1 = rand() % 76 - 6;
+        dx = rand() % 3 ? rand() % 41 - 20 : 0;
+        dy = rand() % 3 ? rand() % 41 - 20 : 0;
+        if(rand() % 20 == 0) dx = rand() % 400 - 200;   // Out of range
+        if(rand() % 20 == 0) dy = rand() % 200 - 100;
+        fill = rand() & 1;
+        cx0 = rand() % 128;
+        cy0 = rand() % 64;
+        cx1 = cx0 + rand() % 128;
+        cy1 = cy0 + rand() % 64;
+        clip = rand() % 4 == 0;
+
+        // The reference: the rectangle, cut to the clip and bitmap, and
+        // each pixel taken from dx,dy back (or fill, from outside it)
+        a = x0 < x1 ? x0 : x1;  b = x0 < x1 ? x1 : x0;
+        c = y0 < y1 ? y0 : y1;  d = y0 < y1 ? y1 : y0;
+        if(clip) {
+            if(a < cx0) a = cx0;
+            if(b > cx1) b = cx1;
+            if(c < cy0) c = cy0;
+            if(d > cy1) d = cy1;
+        }
+        if(a < 0) a = 0;
+        if(b > 127) b = 127;
+        if(c < 0) c = 0;
+        if(d > 63) d = 63;
+
+        memcpy(ref, bitmap, sizeof(ref));
+        memcpy(old, bitmap, sizeof(old));
+        if(dx || dy)
+            for(y = c; y <= d; y++)
+                for(x = a; x <= b; x++) {
+                    sx = x - dx;
+                    sy = y - dy;
+                    if(sx >= a && sx <= b && sy >= c && sy <= d)
+                        setPixel(ref, x, y, getPixel(old, sx, sy));
+                    else
+                        setPixel(ref, x, y, fill);
+                }
+
+        memset(spans, -1, sizeof(spans));
+        if(clip) gfxPushClip(cx0, cy0, cx1, cy1);
+        gfxScrollRegion(x0, y0, x1, y1, dx, dy, fill);
+        if(clip) gfxPopClip();
+
+        CHECK(!memcmp(ref, bitmap, sizeof(ref)));
+
+        // The spans: the rectangle's columns, on each page it touches
+        for(ok = 1, p = 0; p < 8; p++)
+        {
+            want = (dx || dy) && a <= b && c <= d && p >= c / 8 && p <= d / 8;
+            if(want) ok &= spans[p][0] == a && spans[p][1] == b;
+            else     ok &= spans[p][0] == -1;
+        }
+        CHECK(ok);
+    }
+
+    // In a viewport: the same as in screen coordinates
+    randomize();
+    memcpy(old, bitmap, sizeof(old));
+    gfxPushViewport(10, 10, 60, 50);
+    gfxScrollRegion(-5, 0, 50, 45, 3, -5, 1);
+    gfxPopClip();
+    memcpy(ref, bitmap, sizeof(ref));
+    memcpy(bitmap, old, sizeof(bitmap));
+    gfxScrollRegion(10, 10, 60, 50, 3, -5, 1);
+    CHECK(!memcmp(ref, bitmap, sizeof(ref)));
+
+    // Timings
+    gfxSetSpanHook(NULL);
+    for(it = 0; it < (int)(sizeof(dists) / sizeof(dists[0])); it++)
+        printf("scroll by %2d: vertical %.2f us, horizontal %.2f us, "
+               "part vertical %.2f us\n", dists[it],
+               timeScroll(0, 0, 127, 63, 0, dists[it]),
+               timeScroll(0, 0, 127, 63, dists[it], 0),
+               timeScroll(5, 3, 100, 50, 0, dists[it]));
+
+    return mockDone("testScroll");
+}
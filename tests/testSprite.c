@@ -0,0 +1,112 @@
+//
+// testSprite - Sprites (gfxSprite.c): showing, hiding and moving them at
+// random leaves the bitmap as it was underneath, every changed byte is in
+// the spans returned, and the damage flushed brings the LCD up to date.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o testSprite testSprite.c mock.c ../gfxSprite.c
+//        ../gfxDamage.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock.h"
+#include "gfxDamage.h"
+#include "gfxSprite.h"
+#include "st7565.h"
+
+static uint8_t bitmap[1024], under[1024], before[1024];
+static uint8_t image[4][32], mask[4][32];
+
+// True if every byte that differs from before[] is in one of the spans
+static int covered(const gfxSpan_t spans[], uint8_t n)
+{
+    int i, k, page, col, in;
+
+    for(i = 0; i < 1024; i++)
+    {
+        if(bitmap[i] == before[i]) continue;
+        page = i / 128;
+        col = i % 128;
+        for(in = 0, k = 0; k < n; k++)
+            if(spans[k].page == page && col >= spans[k].col0 && col <= spans[k].col1)
+                in = 1;
+        if(!in) return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    gfxSpan_t spans[GFX_SPRITE_MAX_SPANS];
+    int i, k, it, id;
+    uint8_t n;
+
+    srand(1);
+    for(i = 0; i < 1024; i++)
+        under[i] = rand();
+    memcpy(bitmap, under, sizeof(bitmap));
+
+    lcdInit(5, 35);
+    lcdWriteBuffer(bitmap);
+    gfxDamageClear();
+
+    for(k = 0; k < 4; k++)
+        for(i = 0; i < 32; i++) {
+            image[k][i] = rand();
+            mask[k][i] = rand() | image[k][i];
+        }
+    // No mask (or image) bits below the sprites' height: 13 and 7 rows
+    for(i = 0; i < 16; i++) {
+        mask[1][16 + i] &= 0xF8;
+        image[1][16 + i] &= 0xF8;
+    }
+    for(i = 0; i < 5; i++) {
+        mask[3][i] &= 0xFE;
+        image[3][i] &= 0xFE;
+    }
+
+    gfxSpriteInit(bitmap, 128, 64);
+    CHECK(gfxSpriteAdd(image[0], mask[0], 16, 16, GFX_SPRITE_SAVE) == 0);
+    CHECK(gfxSpriteAdd(image[1], mask[1], 16, 13, GFX_SPRITE_SAVE) == 1);
+    CHECK(gfxSpriteAdd(image[2], NULL, 8, 8, GFX_SPRITE_XOR) == 2);
+    CHECK(gfxSpriteAdd(image[3], mask[3], 5, 7, GFX_SPRITE_SAVE) == 3);
+    CHECK(gfxSpriteAdd(image[0], mask[0], 16, 16, GFX_SPRITE_SAVE) == -1);
+    CHECK(gfxSpriteAdd(image[0], mask[0], 17, 16, GFX_SPRITE_SAVE) == -1);
+
+    for(it = 0; it < 50000; it++)
+    {
+        id = rand() % 4;
+        memcpy(before, bitmap, sizeof(bitmap));
+        switch(rand() % 8)
+        {
+        case 0:  n = gfxSpriteShow(id, spans);  break;
+        case 1:  n = gfxSpriteHide(id, spans);  break;
+        default: n = gfxSpriteMove(id, rand() % 160 - 20, rand() % 90 - 15, spans);
+        }
+        CHECK(n <= GFX_SPRITE_MAX_SPANS);
+        CHECK(covered(spans, n));
+
+        if(it % 97 == 0) {
+            // Hiding them all uncovers the bitmap as it was
+            gfxSpriteHideAll();
+            CHECK(!memcmp(bitmap, under, sizeof(bitmap)));
+            gfxSpriteShowAll();
+        }
+        if(it % 101 == 0) {
+            gfxDamageFlush(bitmap);
+            CHECK(mockLcdShows(bitmap));
+        }
+    }
+
+    for(id = 0; id < 4; id++)
+        gfxSpriteHide(id, NULL);
+    CHECK(!memcmp(bitmap, under, sizeof(bitmap)));
+    gfxDamageFlush(bitmap);
+    CHECK(mockLcdShows(bitmap));
+    CHECK(mockLcd.errors == 0);
+
+    return mockDone("testSprite");
+}
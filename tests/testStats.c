@@ -0,0 +1,102 @@
+//
+// testStats - The GFX_STATS instrumentation (gfx.c): a known sequence of
+// primitives gives the calls, bytes and pixels it should, nested calls go
+// to the right counters, RMW passes count as one call, and every call's
+// time lands in the histogram.
+//
+// Build from this directory with:
+//     cc -DGFX_STATS -I. -I.. -o testStats testStats.c mock.c ../gfx.c
+//        ../gfxFont.c ../gfxFont_5x8.c ../st7565.c
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mock.h"
+#include "gfx.h"
+#include "st7565.h"
+
+static uint8_t bitmap[1024];
+static gfxStat_t st[GFX_ST_COUNT];
+
+// True if primitive id has these counts
+static int counted(int id, uint32_t calls, uint32_t bytes, uint32_t pixels)
+{
+    return st[id].calls == calls && st[id].bytes == bytes &&
+           st[id].pixels == pixels;
+}
+
+// True if every primitive's calls are all in its histogram, and each took
+// some time (the mock clock moves on with every read)
+static int timed(void)
+{
+    uint32_t n;
+    int id, b;
+
+    for(id = 0; id < GFX_ST_COUNT; id++)
+    {
+        for(n = 0, b = 0; b < GFX_ST_BUCKETS; b++)
+            n += st[id].hist[b];
+        if(n != st[id].calls || st[id].ticks < st[id].calls)
+            return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    int id, zero;
+
+    lcdInit(5, 35);
+
+    // gfxInit clears the bitmap: a fill of all of it
+    gfxStatsReset();
+    gfxInit(128, 64, bitmap);
+    gfxStatsSnapshot(st);
+    CHECK(counted(GFX_ST_FILL, 1, 1024, 8192));
+
+    gfxStatsReset();
+    gfxStatsSnapshot(st);
+    for(zero = 1, id = 0; id < GFX_ST_COUNT; id++)
+        zero &= counted(id, 0, 0, 0) && st[id].ticks == 0;
+    CHECK(zero);
+
+    // With a bitmap
+    gfxPixel(1, 1, 1);
+    gfxPixel(2, 1, 1);
+    gfxPixel(200, 1, 1);                // Clipped: a call, but no pixel
+    gfxFRect(0, 0, 7, 7, 1);            // 8 whole bytes
+    gfxLine(0, 20, 9, 20, 1);           // 10 pixels
+    gfxRect(10, 10, 19, 19, 1);         // 4 lines: 10 + 10 + 8 + 8 pixels
+    gfxString(0, 5, "ab");              // 2 chars, 5 bytes each
+    gfxChar(0, 6, 'c');
+    gfxStatsSnapshot(st);
+
+    CHECK(counted(GFX_ST_PIXEL, 3, 2, 2));
+    CHECK(counted(GFX_ST_FRECT, 1, 8, 64));
+    CHECK(counted(GFX_ST_LINE, 5, 46, 46));
+    CHECK(counted(GFX_ST_RECT, 1, 0, 0));   // (Its lines have the pixels)
+    CHECK(counted(GFX_ST_CHAR, 3, 15, 120));
+    CHECK(counted(GFX_ST_STRING, 1, 0, 0));
+    CHECK(counted(GFX_ST_FILL, 0, 0, 0));
+    CHECK(timed());
+    // A rectangle's time includes its lines'
+    CHECK(st[GFX_ST_RECT].ticks >= 4);
+
+    // Without a bitmap (RMW): each pass is part of the one call
+    gfxStatsReset();
+    gfxInit(128, 64, NULL);             // A fill, of the LCD
+    gfxPixel(5, 5, 1);
+    gfxFRect(0, 0, 9, 15, 1);           // Two pages of 10 columns
+    gfxStatsSnapshot(st);
+
+    CHECK(counted(GFX_ST_FILL, 1, 1024, 8192));
+    CHECK(counted(GFX_ST_PIXEL, 1, 1, 1));
+    CHECK(counted(GFX_ST_FRECT, 1, 20, 160));
+    CHECK(timed());
+    // Two pages of read-modify-write take longer than a byte
+    CHECK(st[GFX_ST_FRECT].ticks > st[GFX_ST_PIXEL].ticks);
+
+    CHECK(mockLcd.errors == 0);
+    return mockDone("testStats");
+}
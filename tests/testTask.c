@@ -0,0 +1,155 @@
+//
+// testTask - The tick service and cooperative tasks (p32_utils.h, task.h),
+// on the simulated clock: deadlines hold across the tick count's wrap, and
+// the LCD init, flush and touch tasks yield to the rest of the main loop
+// while they wait, and get the same result as their blocking versions.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o testTask testTask.c mock.c ../st7565.c ../tsc2046.c
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mock.h"
+#include "p32_utils.h"
+#include "st7565.h"
+#include "task.h"
+#include "tsc2046.h"
+
+#define LOOP_US 10          // Main loop time per turn, besides the tasks'
+
+static uint32_t turns;      // Turns the other task has had
+static uint8_t bitmap[1024];
+
+// Stands in for the rest of the main loop
+static uint8_t otherTask(task_t *t)
+{
+    TASK_BEGIN(t);
+    while(1) {
+        turns++;
+        TASK_YIELD(t);
+    }
+    TASK_END(t);
+}
+
+static uint8_t delayTask(task_t *t)
+{
+    TASK_BEGIN(t);
+    TASK_DELAY_US(t, 100);
+    TASK_END(t);
+}
+
+static uint8_t blank(void)
+{
+    int page, col;
+
+    for(page = 0; page < 8; page++)
+        for(col = 0; col < 132; col++)
+            if(mockLcd.ram[page][col]) return 0;
+    return 1;
+}
+
+int main(void)
+{
+    task_t t = { 0 }, other = { 0 };
+    uint32_t t0, due, initTicks, yields;
+    int16_t x, y;
+    bool touched;
+    int i;
+
+    // Deadlines across the wrap
+    mockTicks = 0xFFFFFF00u;
+    due = tickNow() + tickFromUs(10);
+    CHECK(!tickExpired(due));
+    mockAdvanceUs(9);
+    CHECK(!tickExpired(due));
+    mockAdvanceUs(1);
+    CHECK(tickExpired(due));
+    CHECK(tickSince(0xFFFFFF00u) >= tickFromUs(10));
+
+    mockTicks = 0xFFFFFFF0u;
+    t0 = mockTicks;
+    turns = 0;
+    while(delayTask(&t) == TASK_WAITING) {
+        otherTask(&other);
+        mockAdvanceUs(1);
+    }
+    CHECK(mockTicks - t0 >= tickFromUs(100));
+    CHECK(mockTicks - t0 < tickFromUs(110));
+    CHECK(turns >= 90);
+
+    // Blocking init: the reference
+    memset(mockLcd.ram, 0xAA, sizeof(mockLcd.ram));
+    t0 = mockTicks;
+    lcdInit(5, 35);
+    initTicks = mockTicks - t0;
+    CHECK(blank());
+    CHECK(mockLcd.on);
+
+    // The init task: the same, with the rest of the loop running meanwhile
+    memset(mockLcd.ram, 0xAA, sizeof(mockLcd.ram));
+    TASK_INIT(&t);
+    t0 = mockTicks;
+    turns = 0;
+    while(lcdInitTask(&t, 5, 35, NULL) == TASK_WAITING) {
+        otherTask(&other);
+        mockAdvanceUs(LOOP_US);
+    }
+    CHECK(blank());
+    CHECK(mockLcd.on);
+    CHECK(turns > initTicks / tickFromUs(LOOP_US) / 2);
+    CHECK(mockTicks - t0 < initTicks + tickFromMs(1));
+
+    // ...coming on showing a frame
+    for(i = 0; i < 1024; i++)
+        bitmap[i] = i * 7 + 3;
+    TASK_INIT(&t);
+    while(lcdInitTask(&t, 5, 35, bitmap) == TASK_WAITING)
+        mockAdvanceUs(LOOP_US);
+    CHECK(mockLcdShows(bitmap));
+
+    // Flush: a page per call
+    for(i = 0; i < 1024; i++)
+        bitmap[i] = i * 13 + 1;
+    TASK_INIT(&t);
+    yields = 0;
+    while(lcdFlushTask(&t, bitmap) == TASK_WAITING)
+        yields++;
+    CHECK(yields >= 7);
+    CHECK(mockLcdShows(bitmap));
+
+    // Touch: the debounce wait lets the loop run
+    mockTsc.code[1] = 2000;         // Y
+    mockTsc.code[3] = 800;          // Z1
+    mockTsc.code[5] = 1000;         // X
+    mockTsc.touching = 1;
+    TASK_INIT(&t);
+    t0 = mockTicks;
+    turns = 0;
+    while(touchGetXYTask(&t, &x, &y, &touched) == TASK_WAITING) {
+        otherTask(&other);
+        mockAdvanceUs(LOOP_US);
+    }
+    CHECK(touched);
+    CHECK(x == 2000 && y == 1000);  // (Axes swapped, TSC_SWAP_XY)
+    CHECK(mockTicks - t0 >= tickFromMs(20));
+    CHECK(turns >= tickFromMs(20) / tickFromUs(LOOP_US) * 9 / 10);
+    CHECK(touchGetXY(&x, &y));
+
+    mockTsc.touching = 0;
+    TASK_INIT(&t);
+    CHECK(touchGetXYTask(&t, &x, &y, &touched) == TASK_DONE);
+    CHECK(!touched);
+
+    // Release: two quiet checks, 20 ms apart
+    TASK_INIT(&t);
+    t0 = mockTicks;
+    while(touchReleaseTask(&t) == TASK_WAITING)
+        mockAdvanceUs(LOOP_US);
+    CHECK(mockTicks - t0 >= tickFromMs(40));
+
+    CHECK(mockLcd.errors == 0);
+    CHECK(mockTsc.errors == 0);
+    return mockDone("testTask");
+}
@@ -0,0 +1,148 @@
+//
+// testTsc - The TSC2046 aux monitor (tscAuxTask) against the TSC model:
+// each channel sampled at its rate, never in the middle of a touch read,
+// averaged to the model's voltages and temperature; and touch calibration.
+//
+// Build from this directory with:
+//     cc -I. -I.. -o testTsc testTsc.c mock.c ../tsc2046.c
+//
+
+#include <stdio.h>
+
+#include "mock.h"
+#include "p32_utils.h"
+#include "task.h"
+#include "tsc2046.h"
+
+#define LOOP_US 50          // Main loop time per turn, besides the tasks'
+
+// Channels (A2..A0)
+#define CH_TEMP0 0
+#define CH_Y     1
+#define CH_VBAT  2
+#define CH_Z1    3
+#define CH_X     5
+#define CH_AUX   6
+#define CH_TEMP1 7
+
+static task_t auxT, touchT;
+static uint32_t auxInTouch;     // Aux conversions during a touch read
+
+// Model inputs: volts, and degrees C
+static void setInputs(double vbat, double vaux, double tempC)
+{
+    mockTsc.code[CH_VBAT]  = (uint16_t)(vbat / 4 / 2.5 * 4096 + 0.5);
+    mockTsc.code[CH_AUX]   = (uint16_t)(vaux / 2.5 * 4096 + 0.5);
+    mockTsc.code[CH_TEMP0] = (uint16_t)(0.600 / 2.5 * 4096 + 0.5);
+    mockTsc.code[CH_TEMP1] = (uint16_t)((0.600 + (tempC + 273.15) / 2573) /
+                                        2.5 * 4096 + 0.5);
+}
+
+static uint32_t auxConversions(void)
+{
+    return mockTsc.conversions[CH_VBAT] + mockTsc.conversions[CH_AUX] +
+           mockTsc.conversions[CH_TEMP0] + mockTsc.conversions[CH_TEMP1];
+}
+
+// Run the aux and touch tasks for ms, a finger down for 150 ms of every
+// 300 if touches
+static uint32_t run(uint32_t ms, uint8_t touches)
+{
+    uint32_t t0 = mockTicks, n = 0, before;
+    uint8_t inTouch = 0, ret;
+    int16_t x, y;
+    bool touched;
+
+    while(mockTicks - t0 < tickFromMs(ms))
+    {
+        before = auxConversions();
+        tscAuxTask(&auxT);
+        if(inTouch && auxConversions() != before)
+            auxInTouch++;
+
+        mockTsc.touching = touches && (mockTicks / tickFromMs(1)) % 300 < 150;
+        ret = touchGetXYTask(&touchT, &x, &y, &touched);
+        inTouch = (ret == TASK_WAITING);
+        if(ret == TASK_DONE && touched)
+            n++;
+
+        mockAdvanceUs(LOOP_US);
+    }
+    return n;
+}
+
+static int near(int32_t fixed, double want, double tol)
+{
+    double v = fixed / (double)(1 << TSC_AUX_FRAC);
+
+    return v > want - tol && v < want + tol;
+}
+
+int main(void)
+{
+    int16_t x, y;
+    uint32_t c;
+
+    mockTsc.code[CH_X] = 1000;
+    mockTsc.code[CH_Y] = 3000;
+    mockTsc.code[CH_Z1] = 800;
+    setInputs(3.70, 1.234, 31.5);
+
+    tscAuxSetRate(TSC_AUX_VBAT, 100, 3);   // 10 Hz, 8 averaged
+    tscAuxSetRate(TSC_AUX_TEMP, 250, 2);   //  4 Hz, 4 averaged
+    tscAuxSetRate(TSC_AUX_AUX,   20, 4);   // 50 Hz, 16 averaged
+    CHECK(tscAuxGet(TSC_AUX_VBAT) == TSC_AUX_NONE);
+    CHECK(tscAuxGet(3) == TSC_AUX_NONE);
+
+    // Sampled at their rates
+    run(2000, 0);
+    CHECK(mockTsc.conversions[CH_VBAT] >= 19 && mockTsc.conversions[CH_VBAT] <= 21);
+    CHECK(mockTsc.conversions[CH_AUX] >= 99 && mockTsc.conversions[CH_AUX] <= 101);
+    CHECK(mockTsc.conversions[CH_TEMP0] >= 7 && mockTsc.conversions[CH_TEMP0] <= 9);
+    CHECK(mockTsc.conversions[CH_TEMP0] == mockTsc.conversions[CH_TEMP1]);
+
+    // ...and around the touch reads, which come first
+    c = mockTsc.conversions[CH_VBAT];
+    CHECK(run(2000, 1) >= 6);
+    CHECK(mockTsc.conversions[CH_VBAT] - c >= 19);
+    CHECK(auxInTouch == 0);
+
+    CHECK(tscAuxUpdates(TSC_AUX_VBAT) == mockTsc.conversions[CH_VBAT] / 8);
+    CHECK(tscAuxUpdates(TSC_AUX_AUX) == mockTsc.conversions[CH_AUX] / 16);
+    CHECK(tscAuxUpdates(TSC_AUX_TEMP) == mockTsc.conversions[CH_TEMP0] / 4);
+
+    // Averages, to within a code or so
+    CHECK(near(tscAuxGet(TSC_AUX_VBAT), 3700, 5));
+    CHECK(near(tscAuxGet(TSC_AUX_AUX), 1234, 1));
+    CHECK(near(tscAuxGet(TSC_AUX_TEMP), 31.5, 1.5));
+
+    // Following changes
+    setInputs(3.10, 1.234, -10);
+    run(3000, 0);
+    CHECK(near(tscAuxGet(TSC_AUX_VBAT), 3100, 5));
+    CHECK(near(tscAuxGet(TSC_AUX_TEMP), -10, 1.5));
+
+    // Rate 0 stops a channel
+    tscAuxSetRate(TSC_AUX_AUX, 0, 0);
+    c = mockTsc.conversions[CH_AUX];
+    x = mockTsc.conversions[CH_VBAT];
+    run(500, 0);
+    CHECK(mockTsc.conversions[CH_AUX] == c);
+    CHECK(mockTsc.conversions[CH_VBAT] - x >= 4);   // (The others go on)
+
+    // Calibration (raw x, y are the Y, X channels: TSC_SWAP_XY)
+    mockTsc.touching = 1;
+    CHECK(touchSetCal(0, 4000, 0, 2000, 128, 64));
+    CHECK(touchGetPixelXY(&x, &y));
+    CHECK(x == 96 && y == 32);
+
+    // Degenerate: refused, and the calibration kept
+    CHECK(!touchSetCal(100, 100, 0, 2000, 128, 64));
+    CHECK(!touchSetCal(0, 4000, 50, 50, 128, 64));
+    CHECK(!touchSetCal(0, 4000, 0, 2000, 0, 64));
+    CHECK(touchGetPixelXY(&x, &y));
+    CHECK(x == 96 && y == 32);
+
+    CHECK(mockTsc.errors == 0);
+    return mockDone("testTsc");
+}
@@ -0,0 +1,180 @@
+//
+// fontsubset - Make a font holding only the characters a program uses
+//              (see gfxFont.h), written as C source.
+//
+// Host tool. Build with e.g.:
+//   cc -I.. -o fontsubset fontsubset.c ../gfxFont.c ../gfxFont_5x8.c
+//
+// Usage:  fontsubset [-a] fontName file.c... > font.c
+//
+// Scans the files' string and character literals (UTF-8, with C escapes;
+// comments are skipped) and keeps the glyphs of gfxFont5x8 for the
+// characters found, plus ' ' and '?' (shown for missing characters).
+// -a also keeps all printable ASCII. Link the output instead of
+// gfxFont_5x8.c, and build with -DGFX_FONT=fontName.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "gfxFont.h"
+
+static uint8_t used[65536];         // 1: code point used
+
+static void fail(const char *msg)
+{
+    fprintf(stderr, "fontsubset: %s\n", msg);
+    exit(1);
+}
+
+// Is the code point in the full font?
+static int inFont(uint16_t cp)
+{
+    uint16_t i;
+
+    for(i = 0; i < gfxFont5x8.nRanges; i++)
+        if(cp >= gfxFont5x8.ranges[i].first && cp <= gfxFont5x8.ranges[i].last)
+            return 1;
+    return 0;
+}
+
+// Read one escape sequence (after the backslash)
+static int escape(FILE *f)
+{
+    int c = fgetc(f), n = 0, i;
+
+    switch(c)
+    {
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case 'a': return '\a';
+    case 'b': return '\b';
+    case 'f': return '\f';
+    case 'v': return '\v';
+    case 'x':
+        while((c = fgetc(f)) != EOF)
+        {
+            if(c >= '0' && c <= '9')      n = n * 16 + c - '0';
+            else if(c >= 'a' && c <= 'f') n = n * 16 + c - 'a' + 10;
+            else if(c >= 'A' && c <= 'F') n = n * 16 + c - 'A' + 10;
+            else break;
+        }
+        ungetc(c, f);
+        return n & 0xff;
+    }
+
+    if(c >= '0' && c <= '7') {
+        for(i = 0; i < 3 && c >= '0' && c <= '7'; i++) {
+            n = n * 8 + c - '0';
+            c = fgetc(f);
+        }
+        ungetc(c, f);
+        return n & 0xff;
+    }
+    return c;   // \\, \", \', \?
+}
+
+// Read a literal's bytes (after the opening quote), and mark its characters
+static void literal(FILE *f, int quote)
+{
+    char buf[4096];
+    const char *p = buf;
+    int c, n = 0;
+    uint16_t cp;
+
+    while((c = fgetc(f)) != EOF && c != quote && c != '\n')
+    {
+        if(c == '\\') c = escape(f);
+        if(n < (int)sizeof(buf) - 1 && c) buf[n++] = c;
+    }
+    buf[n] = 0;
+
+    while((cp = gfxUtf8Next(&p)) != 0)
+        if(cp >= ' ') used[cp] = 1;
+}
+
+static void scan(const char *name)
+{
+    FILE *f = fopen(name, "rb");
+    int c, prev = 0;
+
+    if(!f) fail("can't open input");
+
+    while((c = fgetc(f)) != EOF)
+    {
+        if(prev == '/' && c == '/') {           // Line comment
+            while(c != '\n' && c != EOF) c = fgetc(f);
+        }
+        else if(prev == '/' && c == '*') {      // Block comment
+            prev = 0;
+            while((c = fgetc(f)) != EOF && !(prev == '*' && c == '/'))
+                prev = c;
+            c = 0;
+        }
+        else if(c == '"' || c == '\'') {
+            literal(f, c);
+            c = 0;
+        }
+        prev = c;
+    }
+    fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    const char *name;
+    const uint8_t *g;
+    uint16_t glyph[65536];
+    int i, cp, n = 0, nRanges = 0, skipped = 0, start;
+
+    if(argc > 1 && !strcmp(argv[1], "-a")) {
+        for(cp = ' '; cp < 0x7f; cp++) used[cp] = 1;
+        argv++; argc--;
+    }
+    if(argc < 3) fail("usage: fontsubset [-a] fontName file.c... > font.c");
+    name = argv[1];
+    for(i = 2; i < argc; i++) scan(argv[i]);
+    used[' '] = used['?'] = 1;
+
+    printf("//\n// %s - 5x8 font subset, made by tools/fontsubset\n//\n", name);
+    printf("#include <stdint.h>\n\n#include \"gfxFont.h\"\n\n");
+    printf("static const uint8_t glyphs[] = {\n");
+    for(cp = 0; cp < 65536; cp++)
+    {
+        if(!used[cp]) continue;
+        if(!inFont(cp)) {
+            fprintf(stderr, "fontsubset: no glyph for U+%04X\n", cp);
+            used[cp] = 0;
+            skipped++;
+            continue;
+        }
+        g = gfxFontGlyph(&gfxFont5x8, cp);
+        printf("  0x%02X, 0x%02X, 0x%02X, 0x%02X, 0x%02X,  // %3d: U+%04X\n",
+               g[0], g[1], g[2], g[3], g[4], n, cp);
+        glyph[cp] = n++;
+    }
+    printf("};\n\nstatic const gfxRange_t ranges[] = {\n");
+
+    // Runs of consecutive code points (their glyphs are consecutive too)
+    for(cp = 0; cp < 65536; cp++)
+    {
+        if(!used[cp]) continue;
+        start = cp;
+        while(cp + 1 < 65536 && used[cp + 1]) cp++;
+        printf("    { 0x%04X, 0x%04X, %d },\n", start, cp, glyph[start]);
+        nRanges++;
+    }
+    printf("};\n\nconst gfxFont_t %s = {\n", name);
+    printf("    glyphs, ranges, %d, %d, 0\n};\n", nRanges, glyph['?']);
+
+    fprintf(stderr, "fontsubset: %d glyphs, %d ranges: %d bytes "
+            "(full font: %d glyphs, %d ranges: %d bytes)%s\n",
+            n, nRanges, n * 5 + nRanges * (int)sizeof(gfxRange_t),
+            256, gfxFont5x8.nRanges,
+            256 * 5 + gfxFont5x8.nRanges * (int)sizeof(gfxRange_t),
+            skipped ? "; some characters missing" : "");
+    return 0;
+}
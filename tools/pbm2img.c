@@ -0,0 +1,230 @@
+//
+// pbm2img - Convert a .pbm or .bmp image to a compressed page-format
+//           image (see gfxImage.h), written as C source.
+//
+// Host tool. Build with e.g.:  cc -o pbm2img pbm2img.c
+//
+// Usage:  pbm2img image.pbm|image.bmp arrayName > image.c
+//
+// Reads PBM (P1 text or P4 binary; 1 = black), and uncompressed BMP (1,
+// 8, 24 or 32 bits per pixel; dark pixels are black). Black pixels are
+// the ones turned on. Heights are padded to a whole number of pages.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MAX_W 132   // GFX_IMAGE_MAX_W
+#define MAX_H 256
+
+static int width, height;
+static uint8_t pix[MAX_H][MAX_W];   // 1: pixel on
+
+static void fail(const char *msg)
+{
+    fprintf(stderr, "pbm2img: %s\n", msg);
+    exit(1);
+}
+
+// Next number from a PBM header, skipping white space and comments
+static int pbmNumber(FILE *f)
+{
+    int c, n = 0;
+
+    do {
+        c = fgetc(f);
+        if(c == '#')
+            while(c != '\n' && c != EOF) c = fgetc(f);
+    } while(c == ' ' || c == '\t' || c == '\r' || c == '\n');
+
+    if(c < '0' || c > '9') fail("bad PBM header");
+    while(c >= '0' && c <= '9') {
+        n = n * 10 + c - '0';
+        c = fgetc(f);
+    }
+    return n;
+}
+
+static void readPbm(FILE *f, int binary)
+{
+    int x, y, c = 0;
+
+    width = pbmNumber(f);
+    height = pbmNumber(f);
+    if(width > MAX_W || height > MAX_H) fail("image too large");
+
+    for(y = 0; y < height; y++)
+    {
+        for(x = 0; x < width; x++)
+        {
+            if(binary) {
+                if(x % 8 == 0) c = fgetc(f);
+                pix[y][x] = (c >> (7 - x % 8)) & 1;
+            }
+            else {
+                do c = fgetc(f); while(c != '0' && c != '1' && c != EOF);
+                pix[y][x] = c == '1';
+            }
+        }
+    }
+}
+
+static uint32_t le(const uint8_t *p, int n)
+{
+    uint32_t v = 0;
+
+    while(n--) v = (v << 8) | p[n];
+    return v;
+}
+
+static void readBmp(FILE *f)
+{
+    uint8_t hdr[54], pal[256][4], *line;
+    int32_t h;
+    int bpp, stride, x, y, i, r, g, b, ncolors;
+    uint32_t offset;
+
+    fseek(f, 0, SEEK_SET);
+    if(fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) fail("short BMP header");
+    offset = le(hdr + 10, 4);
+    width = (int)le(hdr + 18, 4);
+    h = (int32_t)le(hdr + 22, 4);
+    bpp = (int)le(hdr + 28, 2);
+    if(le(hdr + 30, 4) != 0 && le(hdr + 30, 4) != 3) fail("compressed BMP");
+    if(width <= 0 || h == 0 || h < -MAX_H) fail("bad BMP size");
+    height = h < 0 ? -h : h;
+    if(width > MAX_W || height > MAX_H) fail("image too large");
+    if(bpp != 1 && bpp != 8 && bpp != 24 && bpp != 32) fail("unsupported BMP depth");
+
+    // Palette follows the info header
+    ncolors = (int)le(hdr + 46, 4);
+    if(!ncolors && bpp <= 8) ncolors = 1 << bpp;
+    if(bpp <= 8 && (ncolors < 0 || ncolors > 256 || ncolors > 1 << bpp))
+        fail("bad BMP palette size");
+    memset(pal, 0, sizeof(pal));        // (Indices past ncolors: black)
+    fseek(f, 14 + le(hdr + 14, 4), SEEK_SET);
+    if(bpp <= 8 && fread(pal, 4, ncolors, f) != (size_t)ncolors) fail("short palette");
+
+    stride = ((width * bpp + 31) / 32) * 4;
+    line = malloc(stride);
+    if(!line) fail("out of memory");
+    fseek(f, offset, SEEK_SET);
+
+    for(i = 0; i < height; i++)
+    {
+        if(fread(line, 1, stride, f) != (size_t)stride) fail("short BMP data");
+        y = h < 0 ? i : height - 1 - i;   // Usually stored bottom-up
+
+        for(x = 0; x < width; x++)
+        {
+            if(bpp == 1 || bpp == 8) {
+                int idx = bpp == 1 ? (line[x / 8] >> (7 - x % 8)) & 1 : line[x];
+                b = pal[idx][0]; g = pal[idx][1]; r = pal[idx][2];
+            }
+            else {
+                b = line[x * (bpp / 8)];
+                g = line[x * (bpp / 8) + 1];
+                r = line[x * (bpp / 8) + 2];
+            }
+            pix[y][x] = (r * 30 + g * 59 + b * 11) < 128 * 100;   // Dark: on
+        }
+    }
+    free(line);
+}
+
+// Page-format byte at column x, page p
+static uint8_t pageByte(int x, int p)
+{
+    uint8_t b = 0;
+    int j;
+
+    for(j = 0; j < 8; j++)
+        if(p * 8 + j < height && pix[p * 8 + j][x])
+            b |= 0x80 >> j;
+    return b;
+}
+
+static uint8_t out[2 + 2 * MAX_W * (MAX_H / 8)];
+static int outLen;
+
+// Compress one page (greedy): copy-above runs of 2+, repeats of 3+,
+// otherwise literals
+static void encodePage(const uint8_t *cur, const uint8_t *above, int w)
+{
+    int i = 0, n, lit;
+
+    while(i < w)
+    {
+        for(n = 0; i + n < w && n < 128 && cur[i + n] == above[i + n]; n++) ;
+        if(n >= 2 || (n == 1 && i + 1 == w)) {
+            out[outLen++] = 0x80 | (n - 1);
+            i += n;
+            continue;
+        }
+
+        for(n = 1; i + n < w && n < 65 && cur[i + n] == cur[i]; n++) ;
+        if(n >= 3) {
+            out[outLen++] = 0x40 | (n - 2);
+            out[outLen++] = cur[i];
+            i += n;
+            continue;
+        }
+
+        // Literal, up to where a better run starts
+        for(lit = 1; i + lit < w && lit < 64; lit++)
+        {
+            int j = i + lit;
+            if(j + 1 < w && cur[j] == above[j] && cur[j + 1] == above[j + 1]) break;
+            if(j + 2 < w && cur[j] == cur[j + 1] && cur[j] == cur[j + 2]) break;
+        }
+        out[outLen++] = lit - 1;
+        memcpy(&out[outLen], &cur[i], lit);
+        outLen += lit;
+        i += lit;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    char magic[2];
+    uint8_t cur[MAX_W], above[MAX_W];
+    int pages, p, x;
+
+    if(argc != 3) {
+        fprintf(stderr, "usage: pbm2img image.pbm|image.bmp arrayName\n");
+        return 1;
+    }
+    if(!(f = fopen(argv[1], "rb"))) fail("can't open input");
+
+    if(fread(magic, 1, 2, f) != 2) fail("empty file");
+    if(magic[0] == 'P' && magic[1] == '1')      readPbm(f, 0);
+    else if(magic[0] == 'P' && magic[1] == '4') readPbm(f, 1);
+    else if(magic[0] == 'B' && magic[1] == 'M') readBmp(f);
+    else fail("not a PBM (P1/P4) or BMP file");
+    fclose(f);
+
+    pages = (height + 7) / 8;
+    out[0] = width;
+    out[1] = pages;
+    outLen = 2;
+
+    memset(above, 0, sizeof(above));
+    for(p = 0; p < pages; p++)
+    {
+        for(x = 0; x < width; x++)
+            cur[x] = pageByte(x, p);
+        encodePage(cur, above, width);
+        memcpy(above, cur, width);
+    }
+
+    printf("// %s: %dx%d pixels, %d bytes (%d uncompressed)\n",
+           argv[1], width, height, outLen, width * pages);
+    printf("#include <stdint.h>\n\nconst uint8_t %s[%d] = {", argv[2], outLen);
+    for(x = 0; x < outLen; x++)
+        printf("%s0x%02X,", x % 12 ? " " : "\n    ", out[x]);
+    printf("\n};\n");
+    return 0;
+}
@@ -0,0 +1,134 @@
+//
+// pgm2pbm - Dither a grayscale .pgm image to a 1bpp .pbm, using the same
+//           code as the target (gfxDither.c), so assets look the same as
+//           images dithered at run time. Feed the result to pbm2img.
+//
+// Host tool. Build from this directory with e.g.:
+//     cc -I.. -o pgm2pbm pgm2pbm.c ../gfxDither.c
+//
+// Usage:  pgm2pbm bayer|fs image.pgm > image.pbm
+//
+// Reads PGM (P2 text or P5 binary, maxval up to 255); writes P4.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "gfxDither.h"
+#include "st7565.h"
+
+#define MAX_H 256
+
+// gfxDither.c's whole-image helpers draw through these; not used here
+void gfxBitmap(int16_t x, int16_t line, int16_t w, int16_t pages,
+               const uint8_t *img)
+{
+    (void)x; (void)line; (void)w; (void)pages; (void)img;
+}
+
+void gfxGetBand(int16_t *width, int16_t *height, uint8_t **band,
+                int16_t *firstPage, int16_t *nPages)
+{
+    *width = *height = *firstPage = *nPages = 0;
+    *band = NULL;
+}
+
+void lcdWriteSpan(uint8_t page, uint8_t col, const uint8_t data[], int n)
+{
+    (void)page; (void)col; (void)data; (void)n;
+}
+
+lcdPanel_t *lcdSelect(lcdPanel_t *panel)
+{
+    return panel;
+}
+
+static void fail(const char *msg)
+{
+    fprintf(stderr, "pgm2pbm: %s\n", msg);
+    exit(1);
+}
+
+// Next number from a PGM header, skipping white space and comments
+static int pgmNumber(FILE *f)
+{
+    int c, n = 0;
+
+    do {
+        c = fgetc(f);
+        if(c == '#')
+            while(c != '\n' && c != EOF) c = fgetc(f);
+    } while(c == ' ' || c == '\t' || c == '\r' || c == '\n');
+
+    if(c < '0' || c > '9') fail("bad PGM header");
+    while(c >= '0' && c <= '9') {
+        n = n * 10 + c - '0';
+        c = fgetc(f);
+    }
+    return n;
+}
+
+// Write out a dithered page (up to 8 rows) as PBM rows
+static void putPage(const uint8_t *page, int w, int rows)
+{
+    int j, x;
+    uint8_t b;
+
+    for(j = 0; j < rows; j++)
+    {
+        for(x = 0, b = 0; x < w; x++)
+        {
+            if(page[x] & (0x80 >> j)) b |= 0x80 >> (x % 8);
+            if(x % 8 == 7 || x == w - 1) {
+                putchar(b);
+                b = 0;
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    char magic[2];
+    uint8_t row[GFX_DITHER_MAX_W], page[GFX_DITHER_MAX_W];
+    int w, h, maxval, binary, x, y, method;
+
+    if(argc != 3) {
+        fprintf(stderr, "usage: pgm2pbm bayer|fs image.pgm > image.pbm\n");
+        return 1;
+    }
+    if(!strcmp(argv[1], "bayer"))   method = GFX_DITHER_BAYER;
+    else if(!strcmp(argv[1], "fs")) method = GFX_DITHER_FS;
+    else fail("method must be bayer or fs");
+
+    if(!(f = fopen(argv[2], "rb"))) fail("can't open input");
+    if(fread(magic, 1, 2, f) != 2 || magic[0] != 'P' ||
+       (magic[1] != '2' && magic[1] != '5'))
+        fail("not a PGM (P2/P5) file");
+    binary = magic[1] == '5';
+
+    w = pgmNumber(f);
+    h = pgmNumber(f);
+    maxval = pgmNumber(f);
+    if(w > GFX_DITHER_MAX_W || h > MAX_H) fail("image too large");
+    if(maxval < 1 || maxval > 255) fail("maxval must be 1..255");
+
+    printf("P4\n%d %d\n", w, h);
+    gfxDitherBegin(method, w, page);
+
+    for(y = 0; y < h; y++)
+    {
+        for(x = 0; x < w; x++)
+            row[x] = (binary ? fgetc(f) : pgmNumber(f)) * 255 / maxval;
+        if(gfxDitherRow(row))
+            putPage(page, w, 8);
+    }
+    if(gfxDitherEnd())
+        putPage(page, w, h % 8);
+
+    fclose(f);
+    return 0;
+}
@@ -3,6 +3,10 @@
 // TSC2046 touch-screen controller
 
 #include "product_config.h"
+#if !defined TSC_MOCK
+#include <plib.h>
+#endif
+
 #include "tsc2046.h"
 #include "p32_utils.h"
 
@@ -18,7 +22,13 @@
 //   D2 = BUSY
 //   D3 = MOSI  (processor to TSC)
 // 
-#if defined ST7565_M4557_PROTOTYPE_STARTERKIT
+// How the lines are driven is up to the transport, tscBus.h.
+//
+#if defined TSC_MOCK
+
+// (No hardware: host build)
+
+#elif defined ST7565_M4557_PROTOTYPE_STARTERKIT
 
 #define TSC_CSn_LO() LATFCLR=BIT_5      // RF5 (PMA8), J10-52 on SKII
 #define TSC_CSn_HI() LATFSET=BIT_5
@@ -42,12 +52,16 @@
   #error Need a product defined
 #endif
 
+#include "tscBus.h"
+
 //
 //  Raw values observed for ESI M4557B
 //
 //  Note: The 64x128 pixel ESI unit will be treated as 128x64 display,
 //        since that jives with the existing ST7565 code. Therefore,
 //        the x axis is the long axis; y is the short axis.
+//        To draw in portrait, see lcdSetOrientation() and
+//        touchSetOrientation().
 //
 //const int16_t x0 = 
 
@@ -69,52 +83,20 @@
 //
 int16_t tscXfer(uint8_t cmd)
 {
-	uint8_t i;
 	int16_t tmp16;
 
-    // TODO: make defines for these ports/bits...
-    TRISESET = 0x000C;   // Normally these are D2 & D3 LCD outputs; Set as inputs
-                         // for use with the TSC: D2=BUSY; D3=SDI (serial data from TSC)
-    TSC_SCK_LO();        // Init clock line low
-    delay_us(2);
-
-    
-    TSC_CSn_LO();        // Activate TSC (chip select)
-    delay_us(2);
-
+    tscBusBegin();
 
     // Send the command byte
-    for(i = 0x80; i; i>>=1)   // Shift a bit-mask from left to right
-    {
-        // Set up the data line
-        if(i & cmd)  TSC_MOSI_HI();
-        else         TSC_MOSI_LO();
-        delay_us(2);
-        
-        // Clock the data
-        TSC_SCK_HI();
-        delay_us(2);
-        TSC_SCK_LO();
-    }
+    tscBusWrite(cmd);
 
-    delay_us(2);
+    tscBusDelayUs(2);
 
     // Clock / Read-back 16 bits. Only 12 bits are significant
-	tmp16 = 0;
-    for(i=0; i<16; i++)
-    {
-        TSC_SCK_HI();
-        delay_us(2);
-        TSC_SCK_LO();
-        delay_us(2);
-		tmp16 <<= 1;
-        tmp16 |= PORTEbits.RE3;   // TODO define for port assignment
-    }
+    tmp16 = tscBusRead16();
 
-    delay_us(2);
-    TSC_CSn_HI();        // De-Activate TSC (chip select)
-
-    TRISECLR = 0x000C;   // Set the LCDs data lines (D2 & D3) as outputs.
+    tscBusDelayUs(2);
+    tscBusEnd();
 
     // Shift the 12 significant bits (currently in the MS bits) down 4 bits.
     tmp16 >>= 4;
@@ -181,23 +163,53 @@ void tscTesting()
 }
 
 
+// A touchGetXYTask is part way through: the touch bus isn't free for aux
+// conversions (see tscAuxTask) until it's done.
+static volatile uint8_t touchBusy = 0;
+
 // If a touch is active, read x,y values and return
 //
 bool touchGetXY(int16_t *x, int16_t *y)
 {
-    int16_t tmpX, tmpY;
+    task_t t;
+    bool touched;
+
+    TASK_RUN(&t, touchGetXYTask(&t, x, y, &touched));
+    return touched;
+}
+
+// touchGetXY as a task (see task.h): the debounce wait lets other tasks
+// run. When it returns TASK_DONE, *touched says whether there was a
+// touch, and if so x,y are set.
+//
+static uint8_t getXYTask(task_t *t, int16_t *x, int16_t *y, bool *touched);
+
+uint8_t touchGetXYTask(task_t *t, int16_t *x, int16_t *y, bool *touched)
+{
+    uint8_t ret = getXYTask(t, x, y, touched);
+
+    touchBusy = (ret == TASK_WAITING);
+    return ret;
+}
+
+static uint8_t getXYTask(task_t *t, int16_t *x, int16_t *y, bool *touched)
+{
+    static int16_t tmpX, tmpY;   // (Kept across the wait)
+
+    TASK_BEGIN(t);
+    *touched = false;
 
     // If no touch  detect, return false.
-    if(tscXfer(TSC_Z1) == 0)  return false;
+    if(tscXfer(TSC_Z1) == 0)  TASK_EXIT(t);
 
     tmpX = tscXfer(TSC_X);      // Read X position
     tmpY = tscXfer(TSC_Y);      // Read Y position
 
     // Check the touch still active now, and again after
     // some delay (to debounce the touch)
-    if(tscXfer(TSC_Z1) == 0) return false;
-    delay_ms(20);
-    if(tscXfer(TSC_Z1) == 0) return false;
+    if(tscXfer(TSC_Z1) == 0) TASK_EXIT(t);
+    TASK_DELAY_MS(t, 20);
+    if(tscXfer(TSC_Z1) == 0) TASK_EXIT(t);
     
     // This seems to be a valid touch. Return true, and the x,y values.
     if(TSC_SWAP_XY)
@@ -210,26 +222,235 @@ bool touchGetXY(int16_t *x, int16_t *y)
         *x = tmpX;
         *y = tmpY;
     }
+    *touched = true;
+
+    TASK_END(t);
+}
+
+
+
+// Raw to pixel calibration, as set by touchSetCal()
+static int16_t calLeft = 0, calRight = 4095;
+static int16_t calTop = 0, calBottom = 4095;
+static int16_t calWidth = 128, calHeight = 64;
+static uint8_t orientation = 0;   // See touchSetOrientation()
+
+bool touchSetCal(int16_t rawLeft, int16_t rawRight,
+                 int16_t rawTop, int16_t rawBottom,
+                 int16_t width, int16_t height)
+{
+    // rawToPixel divides by each axis' raw span
+    if(rawLeft == rawRight || rawTop == rawBottom) return false;
+    if(width < 1 || height < 1) return false;
+
+    calLeft = rawLeft;
+    calRight = rawRight;
+    calTop = rawTop;
+    calBottom = rawBottom;
+    calWidth = width;
+    calHeight = height;
     return true;
 }
 
+// Scale a raw reading to 0..size-1 pixels. (raw0 > raw1 is fine, for
+// an axis that runs backwards.)
+static int16_t rawToPixel(int16_t raw, int16_t raw0, int16_t raw1,
+                          int16_t size)
+{
+    int32_t p = (int32_t)(raw - raw0) * size / (raw1 - raw0);
+
+    if(p < 0) p = 0;
+    if(p >= size) p = size - 1;
+    return (int16_t)p;
+}
+
+void touchSetOrientation(uint8_t orient)
+{
+    orientation = orient;
+}
+
+bool touchGetPixelXY(int16_t *x, int16_t *y)
+{
+    int16_t rawX, rawY, px, py;
+
+    if(!touchGetXY(&rawX, &rawY)) return false;
+
+    // Landscape pixels, as calibrated...
+    px = rawToPixel(rawX, calLeft, calRight, calWidth);
+    py = rawToPixel(rawY, calTop, calBottom, calHeight);
+
+    // ...then rotated to match the display (as lcdWriteBuffer does)
+    switch(orientation)
+    {
+    case 1:  *x = py;                 *y = calWidth - 1 - px;  break; // 90
+    case 2:  *x = calWidth - 1 - px;  *y = calHeight - 1 - py; break; // 180
+    case 3:  *x = calHeight - 1 - py; *y = px;                 break; // 270
+    default: *x = px;                 *y = py;                 break;
+    }
+    return true;
+}
 
 
 // Wait for a touch to be released, with debouncing
 //
 void touchWaitForRelease()
 {
+    task_t t;
+
+    TASK_RUN(&t, touchReleaseTask(&t));
+}
+
+// touchWaitForRelease as a task: TASK_DONE once the touch is released
+//
+uint8_t touchReleaseTask(task_t *t)
+{
+    TASK_BEGIN(t);
+
     while(1)
     {
         // Check a few times, with delays in-between, that no touch is detected.
-        if(tscXfer(TSC_Z1) == 0)
-        {
-            delay_ms(20);
-            if(tscXfer(TSC_Z1) == 0)
-            {
-                delay_ms(20);
-                if(tscXfer(TSC_Z1) == 0) break;  // Looks like a real release
-            }
+        TASK_WAIT_UNTIL(t, tscXfer(TSC_Z1) == 0);
+        TASK_DELAY_MS(t, 20);
+        if(tscXfer(TSC_Z1) != 0) continue;
+        TASK_DELAY_MS(t, 20);
+        if(tscXfer(TSC_Z1) == 0) break;  // Looks like a real release
+    }
+
+    TASK_END(t);
+}
+
+
+//
+// Aux monitor
+//
+// Conversions of the VBAT, AUX and temperature inputs, taken by
+// tscAuxTask in the gaps between touch reads, each at its own rate, and
+// averaged. The averages are kept as single 32-bit words, each written
+// in one store, so they can be read from anywhere without a lock.
+//
+
+typedef struct {
+    uint32_t period;    // Ticks between samples (0: off)
+    uint32_t due;       // Tick count the next sample is due at
+    uint8_t  log2Avg;   // Samples per average: 1 << log2Avg
+    uint16_t n;         // Samples summed so far...
+    int32_t  sum;       //   and their total (raw codes)
+} auxChan_t;
+
+static auxChan_t aux[TSC_AUX_CHANNELS];
+static volatile int32_t  auxValue[TSC_AUX_CHANNELS] =
+    { TSC_AUX_NONE, TSC_AUX_NONE, TSC_AUX_NONE };
+static volatile uint16_t auxUpdates[TSC_AUX_CHANNELS];
+
+// Kelvin per code of TEMP1 - TEMP0, in 16.16 fixed point. The difference
+// is (k T / q) ln 91, i.e. 2.573 K/mV, and a code is Vref / 4096.
+#define TEMP_K_PER_CODE  ((int64_t)TSC_VREF_MV * 2573 * 65536 / (4096 * 1000))
+
+void tscAuxSetRate(uint8_t ch, uint16_t periodMs, uint8_t log2Avg)
+{
+    auxChan_t *a;
+
+    if(ch >= TSC_AUX_CHANNELS) return;
+    a = &aux[ch];
+    a->period = 0;      // (Off while it changes)
+    a->log2Avg = log2Avg > 8 ? 8 : log2Avg;
+    a->n = 0;
+    a->sum = 0;
+    a->due = tickNow();
+    a->period = tickFromMs(periodMs);
+}
+
+int32_t tscAuxGet(uint8_t ch)
+{
+    return ch < TSC_AUX_CHANNELS ? auxValue[ch] : TSC_AUX_NONE;
+}
+
+uint16_t tscAuxUpdates(uint8_t ch)
+{
+    return ch < TSC_AUX_CHANNELS ? auxUpdates[ch] : 0;
+}
+
+// The channel that has been due the longest, or TSC_AUX_CHANNELS if none
+static uint8_t auxDue(void)
+{
+    uint8_t ch, best = TSC_AUX_CHANNELS;
+    int32_t late, most = -1;
+    uint32_t now = tickNow();
+
+    for(ch = 0; ch < TSC_AUX_CHANNELS; ch++)
+    {
+        if(!aux[ch].period) continue;
+        late = (int32_t)(now - aux[ch].due);
+        if(late > most) {
+            most = late;
+            best = ch;
         }
     }
+    return best;
+}
+
+// Take a sample of channel ch, and publish the average when it has them all
+static void auxSample(uint8_t ch)
+{
+    auxChan_t *a = &aux[ch];
+    int32_t code, avg;
+
+    switch(ch)
+    {
+    case TSC_AUX_VBAT:  code = tscXfer(TSC_VBAT);  break;
+    case TSC_AUX_AUX:   code = tscXfer(TSC_AUX);   break;
+    default:
+        code = tscXfer(TSC_TEMP1);
+        code -= tscXfer(TSC_TEMP0);
+        break;
+    }
+
+    // Next one due a period on; if it has fallen behind, don't catch up
+    a->due += a->period;
+    if(tickExpired(a->due))
+        a->due = tickNow() + a->period;
+
+    a->sum += code;
+    if(++a->n < (1 << a->log2Avg))
+        return;
+
+    // Average, in raw codes, with TSC_AUX_FRAC fraction bits
+    avg = a->sum * (1 << TSC_AUX_FRAC) / (1 << a->log2Avg);
+    a->sum = 0;
+    a->n = 0;
+
+    switch(ch)
+    {
+    case TSC_AUX_VBAT:  // (VBAT is divided by 4 on the way in)
+        avg = avg * (TSC_VREF_MV * 4) / 4096;
+        break;
+    case TSC_AUX_AUX:
+        avg = avg * TSC_VREF_MV / 4096;
+        break;
+    default:
+        avg = (int32_t)((avg * TEMP_K_PER_CODE) >> 16) -
+              (27315L << TSC_AUX_FRAC) / 100;
+        break;
+    }
+    auxValue[ch] = avg;
+    auxUpdates[ch]++;
+}
+
+// tscAuxTask() - Run from the main loop alongside the touch tasks. Takes
+// one sample (or the TEMP0/TEMP1 pair) per call at most, and only while
+// no touchGetXYTask is part way through, so it never splits a touch
+// read or stretches its debounce.
+//
+uint8_t tscAuxTask(task_t *t)
+{
+    TASK_BEGIN(t);
+
+    while(1)
+    {
+        TASK_WAIT_UNTIL(t, !touchBusy && (t->i = auxDue()) < TSC_AUX_CHANNELS);
+        auxSample(t->i);
+        TASK_YIELD(t);
+    }
+
+    TASK_END(t);
 }
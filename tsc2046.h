@@ -5,7 +5,9 @@
 //
 
 #include <stdint.h>
-#include <plib.h>
+#include <stdbool.h>
+
+#include "task.h"
 
 // Control byte
 //
@@ -51,7 +53,69 @@ void tscTesting();
 // See if a touch is active; if so, get x,y coords of the touch
 bool touchGetXY(int16_t *x, int16_t *y);
 
+// touchGetXY as a cooperative task (see task.h), so the debounce wait
+// doesn't hold up the rest of the program. Call until it returns
+// TASK_DONE; *touched then says if there was a touch (with x,y set).
+uint8_t touchGetXYTask(task_t *t, int16_t *x, int16_t *y, bool *touched);
+
+// Set the raw readings seen at the display's left, right, top and bottom
+// edges, and its size in pixels, for touchGetPixelXY(). Defaults to the
+// full 0..4095 range on each axis, over 128x64 pixels. Returns false,
+// keeping the calibration it had, if an axis has no span (left == right,
+// or top == bottom) or the size is under a pixel.
+bool touchSetCal(int16_t rawLeft, int16_t rawRight,
+                 int16_t rawTop, int16_t rawBottom,
+                 int16_t width, int16_t height);
+
+// Rotate touchGetPixelXY() results to match the display orientation
+// (0..3 for 0, 90, 180, 270 degrees; see LCD_ORIENT_* in st7565.h).
+// Calibration stays in landscape terms.
+void touchSetOrientation(uint8_t orient);
+
+// As touchGetXY, with x,y converted to display pixels (and limited to
+// the display), in the orientation set by touchSetOrientation().
+bool touchGetPixelXY(int16_t *x, int16_t *y);
+
+// Aux monitor
+//
+// Samples the VBAT, AUX and temperature inputs in the background: run
+// tscAuxTask from the main loop (it never finishes), and it fits the
+// conversions in between touch reads. Each channel has its own rate,
+// and its readings are averaged 1 << log2Avg at a time, so the averages
+// come out every period * (1 << log2Avg) ms. tscAuxGet may be called from
+// anywhere (an interrupt, too); it gets the latest average, in fixed point
+// with TSC_AUX_FRAC fraction bits:
+//   TSC_AUX_VBAT, TSC_AUX_AUX: mV
+//   TSC_AUX_TEMP:              degrees C (from the TEMP0/TEMP1 difference)
+// or TSC_AUX_NONE before the first.
+//
+#define TSC_AUX_VBAT      0
+#define TSC_AUX_AUX       1
+#define TSC_AUX_TEMP      2
+#define TSC_AUX_CHANNELS  3
+
+#define TSC_AUX_FRAC      4
+#define TSC_AUX_NONE      INT32_MIN
+
+#ifndef TSC_VREF_MV
+#define TSC_VREF_MV       2500    // Internal reference
+#endif
+
+// Sample channel ch every periodMs (0: stop), averaging 1 << log2Avg
+// (0..8) readings. Starts a new average.
+void     tscAuxSetRate(uint8_t ch, uint16_t periodMs, uint8_t log2Avg);
+
+uint8_t  tscAuxTask(task_t *t);
+
+int32_t  tscAuxGet(uint8_t ch);
+
+// Number of averages channel ch has had (wraps), to spot a fresh one
+uint16_t tscAuxUpdates(uint8_t ch);
+
 // Wait for a touch to go in-active (with debouncing)
 void touchWaitForRelease();
 
+// touchWaitForRelease as a task: returns TASK_DONE once released
+uint8_t touchReleaseTask(task_t *t);
+
 #endif
@@ -0,0 +1,105 @@
+#ifndef __TSCBUS_H_
+#define __TSCBUS_H_
+
+#include <stdint.h>
+
+//
+// TSC2046 transport
+//
+// What tsc2046.c needs of the serial link to the controller, resolved at
+// compile time (static inline), as lcdBus.h is for the LCD:
+//
+//   tscBusBegin()      - Take the lines (shared with the LCD's data bus on
+//                        the ESI), and select the TSC (/CS low)
+//   tscBusEnd()        - Deselect it, and give the lines back
+//   tscBusWrite(byte)  - Clock a byte out, MS bit first
+//   tscBusRead16()     - Clock 16 bits in, MS bit first
+//   tscBusDelayUs(us)  - Busy-wait
+//
+// Backends:
+//
+//   (default)  - Bit-banged on the board's port pins (TSC_CSn_, TSC_SCK_,
+//                TSC_MOSI_; BUSY and the TSC's DOUT on RE2, RE3)
+//   TSC_MOCK   - No hardware: calls the tscMock hooks below, which the
+//                host program supplies
+//
+// Included by tsc2046.c, after the board's pin definitions.
+//
+
+#if defined TSC_MOCK
+
+void     tscMockSelect(uint8_t on);
+void     tscMockWrite(uint8_t data);
+uint16_t tscMockRead16(void);
+void     tscMockDelayUs(uint32_t us);
+
+static inline void tscBusBegin(void)        { tscMockSelect(1); }
+static inline void tscBusEnd(void)          { tscMockSelect(0); }
+static inline void tscBusWrite(uint8_t d)   { tscMockWrite(d); }
+static inline uint16_t tscBusRead16(void)   { return tscMockRead16(); }
+static inline void tscBusDelayUs(uint32_t us) { tscMockDelayUs(us); }
+
+#else   // GPIO
+
+static inline void tscBusDelayUs(uint32_t us)
+{
+    delay_us(us);
+}
+
+static inline void tscBusBegin(void)
+{
+    // TODO: make defines for these ports/bits...
+    TRISESET = 0x000C;   // Normally these are D2 & D3 LCD outputs; Set as inputs
+                         // for use with the TSC: D2=BUSY; D3=SDI (serial data from TSC)
+    TSC_SCK_LO();        // Init clock line low
+    delay_us(2);
+
+    TSC_CSn_LO();        // Activate TSC (chip select)
+    delay_us(2);
+}
+
+static inline void tscBusEnd(void)
+{
+    TSC_CSn_HI();        // De-Activate TSC (chip select)
+
+    TRISECLR = 0x000C;   // Set the LCDs data lines (D2 & D3) as outputs.
+}
+
+static inline void tscBusWrite(uint8_t d)
+{
+    uint8_t i;
+
+    for(i = 0x80; i; i>>=1)   // Shift a bit-mask from left to right
+    {
+        // Set up the data line
+        if(i & d)  TSC_MOSI_HI();
+        else       TSC_MOSI_LO();
+        delay_us(2);
+
+        // Clock the data
+        TSC_SCK_HI();
+        delay_us(2);
+        TSC_SCK_LO();
+    }
+}
+
+static inline uint16_t tscBusRead16(void)
+{
+    uint16_t d = 0;
+    uint8_t i;
+
+    for(i=0; i<16; i++)
+    {
+        TSC_SCK_HI();
+        delay_us(2);
+        TSC_SCK_LO();
+        delay_us(2);
+        d <<= 1;
+        d |= PORTEbits.RE3;   // TODO define for port assignment
+    }
+    return d;
+}
+
+#endif
+
+#endif
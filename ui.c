@@ -0,0 +1,356 @@
+//
+// ui.c - Retained-mode widgets with damage tracking and touch hit-testing
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "gfx.h"
+#include "gfxDamage.h"
+#include "st7565.h"
+#include "ui.h"
+
+enum { wLABEL, wBUTTON, wREADOUT, wGAUGE, wCHECKBOX };
+
+#define fDIRTY   0x01   // Needs redraw
+#define fPRESSED 0x02   // Button is being touched
+
+typedef struct {
+    uint8_t type;
+    uint8_t flags;
+    int16_t x, y, w, h;       // Bounding rectangle (pixels)
+    const char *text;
+    int32_t value;
+    int16_t min, max;         // Gauge range
+    uint8_t decimals;         // Readout decimal places
+} widget_t;
+
+#define READOUT_MAX 21   // Characters in a readout, at most (one line)
+
+// Touch grid: the screen is split into CELL x CELL pixel cells, each
+// holding a bit per widget overlapping that cell. It's sized for 128
+// pixels both ways, so either orientation (128x64 or 64x128) fits.
+#define CELL     16
+#define GRID_W   (128 / CELL)
+#define GRID_H   (128 / CELL)
+
+//
+// Private variables
+//
+static widget_t widgets[UI_MAX_WIDGETS];
+static int8_t   nWidgets;
+static uint16_t grid[GRID_H][GRID_W];
+static uint8_t  *bmap;         // Bitmap being drawn by gfx
+static int8_t   pressedId = -1;  // Widget touched down on
+static bool     touchHeld;       // Touch still down since it began
+static int16_t  scrW, scrH;      // Screen size (pixels), from the LCD
+
+
+void uiInit(uint8_t *bitmap)
+{
+    bmap = bitmap;
+    nWidgets = 0;
+    pressedId = -1;
+    touchHeld = false;
+    memset(grid, 0, sizeof(grid));
+    lcdGetSize(&scrW, &scrH);
+
+    gfxFill(0);
+    gfxDamageAll();
+}
+
+// Add a widget, and mark it for drawing. Returns NULL if full.
+static widget_t *addWidget(uint8_t type, int16_t x, int16_t y,
+                           int16_t w, int16_t h)
+{
+    widget_t *wp;
+
+    if(nWidgets >= UI_MAX_WIDGETS) return NULL;
+
+    wp = &widgets[nWidgets++];
+    memset(wp, 0, sizeof(*wp));
+    wp->type = type;
+    wp->flags = fDIRTY;
+    wp->x = x;
+    wp->y = y;
+    wp->w = w;
+    wp->h = h;
+    return wp;
+}
+
+// True if a touchable widget lies wholly on the screen (and so in the grid)
+static bool onScreen(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    return x >= 0 && y >= 0 && w > 0 && h > 0 &&
+           x + w <= scrW && y + h <= scrH;
+}
+
+// Enter a widget in the touch grid
+static void addToGrid(int8_t id)
+{
+    widget_t *wp = &widgets[id];
+    int16_t cx, cy;
+    int16_t cx0 = wp->x / CELL, cx1 = (wp->x + wp->w - 1) / CELL;
+    int16_t cy0 = wp->y / CELL, cy1 = (wp->y + wp->h - 1) / CELL;
+
+    if(cx0 < 0) cx0 = 0;
+    if(cy0 < 0) cy0 = 0;
+    if(cx1 >= GRID_W) cx1 = GRID_W - 1;
+    if(cy1 >= GRID_H) cy1 = GRID_H - 1;
+
+    for(cy = cy0; cy <= cy1; cy++)
+        for(cx = cx0; cx <= cx1; cx++)
+            grid[cy][cx] |= 1 << id;
+}
+
+int8_t uiLabel(int16_t x, int16_t line, const char *text)
+{
+    widget_t *wp = addWidget(wLABEL, x, line * 8, gfxTextLen(text) * 6, 8);
+
+    if(!wp) return -1;
+    wp->text = text;
+    return nWidgets - 1;
+}
+
+int8_t uiButton(int16_t x, int16_t y, int16_t w, int16_t h, const char *text)
+{
+    widget_t *wp;
+
+    if(!onScreen(x, y, w, h)) return -1;
+    wp = addWidget(wBUTTON, x, y, w, h);
+
+    if(!wp) return -1;
+    wp->text = text;
+    addToGrid(nWidgets - 1);
+    return nWidgets - 1;
+}
+
+int8_t uiReadout(int16_t x, int16_t line, uint8_t width, uint8_t decimals)
+{
+    widget_t *wp;
+
+    if(width < 1 || width > READOUT_MAX) return -1;
+    wp = addWidget(wREADOUT, x, line * 8, width * 6, 8);
+
+    if(!wp) return -1;
+    wp->decimals = decimals;
+    return nWidgets - 1;
+}
+
+int8_t uiGauge(int16_t x, int16_t y, int16_t w, int16_t h,
+               int16_t min, int16_t max)
+{
+    widget_t *wp;
+
+    if(min >= max) return -1;       // (No range to show)
+    wp = addWidget(wGAUGE, x, y, w, h);
+
+    if(!wp) return -1;
+    wp->min = min;
+    wp->max = max;
+    wp->value = min;
+    return nWidgets - 1;
+}
+
+int8_t uiCheckbox(int16_t x, int16_t line, const char *text)
+{
+    widget_t *wp;
+    int16_t w = 9 + gfxTextLen(text) * 6;
+
+    if(!onScreen(x, line * 8, w, 8)) return -1;
+    wp = addWidget(wCHECKBOX, x, line * 8, w, 8);
+
+    if(!wp) return -1;
+    wp->text = text;
+    addToGrid(nWidgets - 1);
+    return nWidgets - 1;
+}
+
+void uiSetText(int8_t id, const char *text)
+{
+    if(id < 0 || id >= nWidgets) return;
+    widgets[id].text = text;
+    widgets[id].flags |= fDIRTY;
+}
+
+void uiSetValue(int8_t id, int32_t value)
+{
+    if(id < 0 || id >= nWidgets || widgets[id].value == value) return;
+    widgets[id].value = value;
+    widgets[id].flags |= fDIRTY;
+}
+
+int32_t uiGetValue(int8_t id)
+{
+    if(id < 0 || id >= nWidgets) return 0;
+    return widgets[id].value;
+}
+
+// Format a readout's value, right-aligned, into buf (width chars + null;
+// width is at most READOUT_MAX). A value too wide for it shows as "---".
+static void formatReadout(widget_t *wp, char *buf)
+{
+    int16_t width = wp->w / 6;
+    int16_t i = width;
+    uint8_t neg = wp->value < 0, places = 0;
+    uint32_t v = neg ? 0u - (uint32_t)wp->value : (uint32_t)wp->value;
+
+    buf[i--] = 0;
+
+    // Digits, least significant first, with the decimal point inserted
+    do {
+        if(places == wp->decimals && wp->decimals && i >= 0)
+            buf[i--] = '.';
+        if(i >= 0) buf[i--] = '0' + v % 10;
+        v /= 10;
+        places++;
+    } while(i >= 0 && (v || places <= wp->decimals));
+
+    if(v || places <= wp->decimals || (neg && i < 0)) {
+        // Overflow: don't show a number with digits or its sign missing
+        for(i = width - 1; i >= 0; i--)
+            buf[i] = i >= width - 3 ? '-' : ' ';
+        return;
+    }
+
+    if(neg) buf[i--] = '-';
+    while(i >= 0) buf[i--] = ' ';
+}
+
+static void drawWidget(widget_t *wp)
+{
+    char buf[READOUT_MAX + 1];
+    int16_t x1 = wp->x + wp->w - 1, y1 = wp->y + wp->h - 1;
+    int32_t v, fill;
+
+    gfxPushClip(wp->x, wp->y, x1, y1);   // Don't draw over neighbours
+    gfxFRect(wp->x, wp->y, x1, y1, 0);   // Erase the old
+
+    switch(wp->type)
+    {
+    case wLABEL:
+        gfxString(wp->x, wp->y / 8, (char *)wp->text);
+        break;
+
+    case wBUTTON:
+        gfxRect(wp->x, wp->y, x1, y1, 1);
+        if(wp->flags & fPRESSED)          // Pressed: heavier outline
+            gfxRect(wp->x + 1, wp->y + 1, x1 - 1, y1 - 1, 1);
+        gfxString(wp->x + (wp->w - gfxTextLen(wp->text) * 6) / 2 + 1,
+                  (wp->y + wp->h / 2 - 4) / 8, (char *)wp->text);
+        break;
+
+    case wREADOUT:
+        formatReadout(wp, buf);
+        gfxString(wp->x, wp->y / 8, buf);
+        break;
+
+    case wGAUGE:
+        gfxRect(wp->x, wp->y, x1, y1, 1);
+        v = wp->value;                    // (Out of range: pinned to an end)
+        if(v < wp->min) v = wp->min;
+        if(v > wp->max) v = wp->max;
+        fill = (v - wp->min) * (wp->w - 4) / (wp->max - wp->min);
+        if(fill > wp->w - 4) fill = wp->w - 4;
+        if(fill > 0)
+            gfxFRect(wp->x + 2, wp->y + 2, wp->x + 1 + fill, y1 - 2, 1);
+        break;
+
+    case wCHECKBOX:
+        gfxRect(wp->x, wp->y + 1, wp->x + 6, wp->y + 7, 1);
+        if(wp->value)
+            gfxFRect(wp->x + 2, wp->y + 3, wp->x + 4, wp->y + 5, 1);
+        gfxString(wp->x + 9, wp->y / 8, (char *)wp->text);
+        break;
+    }
+    gfxPopClip();
+
+    gfxDamageRect(wp->x, wp->y, x1, y1);
+}
+
+uint16_t uiRedraw(void)
+{
+    int8_t id;
+
+    for(id = 0; id < nWidgets; id++)
+    {
+        if(widgets[id].flags & fDIRTY) {
+            drawWidget(&widgets[id]);
+            widgets[id].flags &= ~fDIRTY;
+        }
+    }
+    return gfxDamageFlush(bmap);
+}
+
+// Topmost (last created) touchable widget under x,y; -1 if none
+static int8_t hitTest(int16_t x, int16_t y)
+{
+    uint16_t cands;
+    int8_t id;
+    widget_t *wp;
+
+    if(x < 0 || y < 0 || x >= scrW || y >= scrH)
+        return -1;
+
+    cands = grid[y / CELL][x / CELL];
+    for(id = UI_MAX_WIDGETS - 1; cands && id >= 0; id--)
+    {
+        if(!(cands & (1 << id))) continue;
+        cands &= ~(1 << id);
+
+        wp = &widgets[id];
+        if(x >= wp->x && x < wp->x + wp->w &&
+           y >= wp->y && y < wp->y + wp->h)
+            return id;
+    }
+    return -1;
+}
+
+static void setPressed(int8_t id, uint8_t pressed)
+{
+    if(id < 0) return;
+    if(pressed) widgets[id].flags |= fPRESSED;
+    else        widgets[id].flags &= ~fPRESSED;
+    widgets[id].flags |= fDIRTY;
+}
+
+int8_t uiTouch(int16_t x, int16_t y, bool down)
+{
+    int8_t id, was = pressedId;
+
+    if(!down)
+    {
+        // Release: a button is "clicked" if released while pressed
+        pressedId = -1;
+        touchHeld = false;
+        if(was >= 0 && widgets[was].type == wBUTTON) {
+            setPressed(was, 0);
+            return was;
+        }
+        return -1;
+    }
+
+    if(touchHeld) {
+        // Still down; a finger sliding off a button un-presses it
+        if(pressedId >= 0 && widgets[pressedId].type == wBUTTON &&
+           hitTest(x, y) != pressedId) {
+            setPressed(pressedId, 0);
+            pressedId = -1;
+        }
+        return -1;
+    }
+
+    touchHeld = true;
+    id = hitTest(x, y);
+    if(id < 0) return -1;
+
+    pressedId = id;
+    if(widgets[id].type == wCHECKBOX) {
+        // Toggle on touch-down; holding doesn't repeat
+        uiSetValue(id, !widgets[id].value);
+        return id;
+    }
+    setPressed(id, 1);
+    return -1;
+}
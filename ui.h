@@ -0,0 +1,66 @@
+#ifndef __UI_H__
+#define __UI_H__
+
+//
+// Retained-mode widgets
+//
+// Widgets are created once, then updated by changing their properties.
+// A change marks only that widget as needing redraw; uiRedraw() then
+// redraws those widgets into the bitmap and sends just the changed bytes
+// to the LCD (see gfxDamage.h).
+//
+// Widgets are drawn with the gfx routines, so gfxInit() must have been
+// called, with the same bitmap buffer that is passed to uiInit().
+//
+// Touch: Pass touch state in pixel coordinates to uiTouch(), e.g.
+//
+//     int16_t x, y;
+//     bool down = touchGetPixelXY(&x, &y);
+//     id = uiTouch(x, y, down);
+//
+// Only buttons and checkboxes respond to touch. They are found through a
+// coarse grid of the screen, so a touch is tested only against widgets
+// that overlap its grid cell.
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UI_MAX_WIDGETS 16   // (At most 16: the touch grid uses a bit each)
+
+// Widget creation. Each returns the new widget's id, or -1 if there's no
+// room left (or its size or range can't be shown). Buttons and checkboxes
+// must lie wholly on the screen (as lcdGetSize gives it when uiInit is
+// called). Text and labels are positioned by 8-pixel line, like gfxString();
+// text pointers must stay valid while the widget exists.
+int8_t uiLabel(int16_t x, int16_t line, const char *text);
+int8_t uiButton(int16_t x, int16_t y, int16_t w, int16_t h, const char *text);
+int8_t uiReadout(int16_t x, int16_t line,   // Number, right-aligned in
+                 uint8_t width,             // "width" characters (1..21),
+                 uint8_t decimals);         // with an implied decimal point
+                                            // ("---" if it doesn't fit)
+int8_t uiGauge(int16_t x, int16_t y, int16_t w, int16_t h,
+               int16_t min, int16_t max);   // Horizontal bar (min < max;
+                                            // values outside it pin to an end)
+int8_t uiCheckbox(int16_t x, int16_t line, const char *text);
+
+// Remove all widgets, and clear the bitmap
+void uiInit(uint8_t *bitmap);
+
+// Property changes. Each marks the widget for redraw if the property
+// changed (setting text always does, as the string may have changed).
+void uiSetText(int8_t id, const char *text);
+void uiSetValue(int8_t id, int32_t value);   // Readout or gauge value, or
+                                             // checkbox state (0/1)
+int32_t uiGetValue(int8_t id);
+
+// Redraw changed widgets, and send the changes to the LCD. Returns the
+// number of display data bytes sent.
+uint16_t uiRedraw(void);
+
+// Feed touch state (pixel coords; "down" false when not touched). Returns
+// the id of a button released while still pressed, or of a checkbox that
+// was toggled; otherwise -1.
+int8_t uiTouch(int16_t x, int16_t y, bool down);
+
+#endif